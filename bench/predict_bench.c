@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * predict_bench: time sh2_predictOrientation() on the host.
+ *
+ * Build and run from the repository root:
+ *   gcc -std=gnu11 -O2 -I. bench/predict_bench.c sh2_predict.c -lm -o predict_bench
+ *   ./predict_bench [ITERATIONS]
+ *
+ * Feeds one GIRV report, then predicts to a moving target time and prints
+ * the mean time per prediction.
+ */
+
+#include "sh2_predict.h"
+#include "sh2_err.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_ITERATIONS (10000000)
+
+// ------------------------------------------------------------------------
+// Private functions
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1.0e-9;
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+int main(int argc, char *argv[])
+{
+    unsigned long iterations = DEFAULT_ITERATIONS;
+    struct sh2_GyroIntegratedRV girv;
+    sh2_Quaternion_t q;
+    double sum = 0.0;
+
+    if (argc > 1) {
+        iterations = strtoul(argv[1], 0, 0);
+        if (iterations == 0) {
+            fprintf(stderr, "usage: predict_bench [ITERATIONS]\n");
+            return 1;
+        }
+    }
+
+    // Turning at about 1 rad/s about a tilted axis.
+    girv.i = 0.1f;
+    girv.j = 0.2f;
+    girv.k = 0.3f;
+    girv.real = 0.927f;
+    girv.angVelX = 0.6f;
+    girv.angVelY = 0.0f;
+    girv.angVelZ = 0.8f;
+
+    sh2_predictReset();
+    sh2_predictGirvCallback(0, &girv, 1000000);
+
+    double start = nowSeconds();
+    for (unsigned long n = 0; n < iterations; n++) {
+        if (sh2_predictOrientation(1000000 + (n % 50000), &q) != SH2_OK) {
+            fprintf(stderr, "prediction failed\n");
+            return 1;
+        }
+        sum += q.w;  // Keep the result live
+    }
+    double elapsed = nowSeconds() - start;
+
+    printf("%lu predictions, %.3f us each (checksum %.3f)\n",
+           iterations, elapsed * 1.0e6 / iterations, sum);
+
+    return 0;
+}
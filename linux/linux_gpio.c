@@ -0,0 +1,203 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * GPIO character device helpers for the Linux reference HALs.
+ */
+
+#include "linux_gpio.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <linux/gpio.h>
+
+// Edge events read from the line fd in one read() call.
+#define EDGE_BATCH (16)
+
+// ------------------------------------------------------------------------
+// Private functions
+
+static int requestLine(const char *chip, unsigned line, uint64_t flags,
+                       bool asserted, const char *consumer)
+{
+    struct gpio_v2_line_request req;
+    int chipFd;
+    int rc;
+
+    chipFd = open(chip, O_RDWR | O_CLOEXEC);
+    if (chipFd < 0) {
+        return -1;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.offsets[0] = line;
+    req.num_lines = 1;
+    req.config.flags = flags;
+    if (flags & GPIO_V2_LINE_FLAG_OUTPUT) {
+        req.config.num_attrs = 1;
+        req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        req.config.attrs[0].attr.values = asserted ? 1 : 0;
+        req.config.attrs[0].mask = 1;
+    }
+    strncpy(req.consumer, consumer ? consumer : "sh2", sizeof(req.consumer)-1);
+
+    rc = ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &req);
+
+    // The line fd stays valid after the chip is closed.
+    close(chipFd);
+
+    if (rc < 0) {
+        return -1;
+    }
+
+    return req.fd;
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+int linux_gpioRequestIntn(const char *chip, unsigned line, const char *consumer)
+{
+    // With ACTIVE_LOW, a "rising" edge is the inactive->active transition,
+    // i.e. the physical falling edge of H_INTN.
+    int fd = requestLine(chip, line,
+                         GPIO_V2_LINE_FLAG_INPUT |
+                         GPIO_V2_LINE_FLAG_ACTIVE_LOW |
+                         GPIO_V2_LINE_FLAG_EDGE_RISING,
+                         false, consumer);
+    if (fd < 0) {
+        return -1;
+    }
+
+    // Never block in read(): edges are consumed opportunistically.
+    int fl = fcntl(fd, F_GETFL);
+    if ((fl < 0) || (fcntl(fd, F_SETFL, fl | O_NONBLOCK) < 0)) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+int linux_gpioRequestOutput(const char *chip, unsigned line, bool asserted,
+                            const char *consumer)
+{
+    return requestLine(chip, line,
+                       GPIO_V2_LINE_FLAG_OUTPUT | GPIO_V2_LINE_FLAG_ACTIVE_LOW,
+                       asserted, consumer);
+}
+
+int linux_gpioGet(int fd)
+{
+    struct gpio_v2_line_values vals;
+
+    memset(&vals, 0, sizeof(vals));
+    vals.mask = 1;
+    if (ioctl(fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &vals) < 0) {
+        return -1;
+    }
+
+    return (vals.bits & 1) ? 1 : 0;
+}
+
+int linux_gpioSet(int fd, bool asserted)
+{
+    struct gpio_v2_line_values vals;
+
+    memset(&vals, 0, sizeof(vals));
+    vals.mask = 1;
+    vals.bits = asserted ? 1 : 0;
+    if (ioctl(fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &vals) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int linux_gpioWaitEdge(int fd, int timeout_ms, uint64_t *pEdge_ns)
+{
+    struct gpio_v2_line_event events[EDGE_BATCH];
+    int edges = 0;
+
+    if (timeout_ms != 0) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int rc = poll(&pfd, 1, timeout_ms);
+        if ((rc < 0) && (errno != EINTR)) {
+            return -1;
+        }
+    }
+
+    // Drain everything pending; the fd is non-blocking.
+    for (;;) {
+        ssize_t got = read(fd, events, sizeof(events));
+        if (got < 0) {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+                break;
+            }
+            return -1;
+        }
+
+        int n = got / sizeof(events[0]);
+        if (n > 0) {
+            *pEdge_ns = events[n-1].timestamp_ns;
+            edges += n;
+        }
+        if (n < EDGE_BATCH) {
+            break;
+        }
+    }
+
+    return edges;
+}
+
+bool linux_gpioWaitAsserted(int fd, int timeout_ms, uint64_t *pEdge_ns, bool *pNewEdge)
+{
+    uint64_t edge_ns = 0;
+    int edges;
+
+    edges = linux_gpioWaitEdge(fd, 0, &edge_ns);
+    if (linux_gpioGet(fd) != 1) {
+        if (timeout_ms == 0) {
+            return false;
+        }
+
+        // Sleep in the kernel until the next assertion
+        edges = linux_gpioWaitEdge(fd, timeout_ms, &edge_ns);
+        if (linux_gpioGet(fd) != 1) {
+            return false;
+        }
+    }
+
+    if (edges > 0) {
+        *pEdge_ns = edge_ns;
+        *pNewEdge = true;
+    }
+
+    return true;
+}
+
+void linux_gpioRelease(int fd)
+{
+    if (fd >= 0) {
+        close(fd);
+    }
+}
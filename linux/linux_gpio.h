@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * GPIO character device helpers for the Linux reference HALs.
+ *
+ * Lines are requested through the GPIO v2 uAPI (/dev/gpiochipN).  The
+ * sensor hub control lines (H_INTN, NRST, PS0/WAKE) are all active-low
+ * so they are requested with GPIO_V2_LINE_FLAG_ACTIVE_LOW: a value of 1
+ * always means "asserted", regardless of the physical level.
+ */
+
+#ifndef LINUX_GPIO_H
+#define LINUX_GPIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Request an input line that reports assertion edges (physical falling
+// edges) as line events, timestamped by the kernel with CLOCK_MONOTONIC.
+// Returns the line request fd, which is readable when an edge is pending
+// and can be handed to poll().  Returns -1 on error.
+int linux_gpioRequestIntn(const char *chip, unsigned line, const char *consumer);
+
+// Request an output line, initially set to the given asserted state.
+// Returns the line request fd or -1 on error.
+int linux_gpioRequestOutput(const char *chip, unsigned line, bool asserted,
+                            const char *consumer);
+
+// Read the asserted state of a requested line.
+// Returns 1 if asserted, 0 if not, -1 on error.
+int linux_gpioGet(int fd);
+
+// Set the asserted state of a requested output line.
+// Returns 0 on success, -1 on error.
+int linux_gpioSet(int fd, bool asserted);
+
+// Wait up to timeout_ms (0: don't wait, -1: forever) for edge events and
+// consume all that are pending.  If any were consumed, *pEdge_ns is set to
+// the kernel timestamp of the most recent one, which is the edge that
+// started the current assertion.  Returns the number of edges consumed,
+// or -1 on error.
+int linux_gpioWaitEdge(int fd, int timeout_ms, uint64_t *pEdge_ns);
+
+// Check whether an H_INTN line is asserted, waiting up to timeout_ms for
+// it if not.  If an assertion edge was consumed, its kernel timestamp is
+// stored in *pEdge_ns and *pNewEdge is set; otherwise neither is changed.
+// Returns true if the line is asserted.
+bool linux_gpioWaitAsserted(int fd, int timeout_ms, uint64_t *pEdge_ns, bool *pNewEdge);
+
+// Release a line requested by one of the functions above.
+void linux_gpioRelease(int fd);
+
+#endif
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Reference SH2 HAL for Linux i2c-dev.
+ */
+
+#include "linux_i2c_hal.h"
+#include "linux_gpio.h"
+#include "sh2_err.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+// ------------------------------------------------------------------------
+// Private definitions
+
+#define SHTP_HDR_LEN (4)
+
+// Reset timing: NRST asserted for RESET_HOLD_US, then released.
+#define RESET_HOLD_US (10000)
+
+#define CONSUMER "sh2-i2c"
+
+// ------------------------------------------------------------------------
+// Private functions
+
+static uint64_t nowUs(void)
+{
+    struct timespec ts;
+
+    // Same clock as the GPIO edge timestamps
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+static uint32_t i2cHalGetTimeUs(sh2_Hal_t *self)
+{
+    (void)self; // unused
+
+    return (uint32_t)nowUs();
+}
+
+// One I2C_RDWR transaction with a single message.
+static int i2cXfer(linux_I2cHal_t *pI2cHal, uint16_t flags, uint8_t *pBuffer, unsigned len)
+{
+    struct i2c_msg msg;
+    struct i2c_rdwr_ioctl_data data;
+
+    msg.addr = pI2cHal->config.address;
+    msg.flags = flags;
+    msg.len = len;
+    msg.buf = pBuffer;
+    data.msgs = &msg;
+    data.nmsgs = 1;
+
+    if (ioctl(pI2cHal->i2cFd, I2C_RDWR, &data) < 0) {
+        pI2cHal->ioErrors++;
+        return SH2_ERR_IO;
+    }
+
+    return SH2_OK;
+}
+
+static void releaseLines(linux_I2cHal_t *pI2cHal)
+{
+    linux_gpioRelease(pI2cHal->intnFd);
+    linux_gpioRelease(pI2cHal->resetFd);
+    pI2cHal->intnFd = -1;
+    pI2cHal->resetFd = -1;
+}
+
+static int requestLines(linux_I2cHal_t *pI2cHal)
+{
+    const linux_I2cHalConfig_t *pConfig = &pI2cHal->config;
+
+    pI2cHal->intnFd = linux_gpioRequestIntn(pConfig->gpioChip, pConfig->intnLine, CONSUMER);
+    if (pI2cHal->intnFd < 0) {
+        return SH2_ERR_IO;
+    }
+
+    if (pConfig->resetLine >= 0) {
+        pI2cHal->resetFd = linux_gpioRequestOutput(pConfig->gpioChip, pConfig->resetLine,
+                                                   true, CONSUMER);
+        if (pI2cHal->resetFd < 0) {
+            return SH2_ERR_IO;
+        }
+    }
+
+    return SH2_OK;
+}
+
+static int i2cHalOpen(sh2_Hal_t *self)
+{
+    linux_I2cHal_t *pI2cHal = (linux_I2cHal_t *)self;
+    int rc = SH2_OK;
+
+    pI2cHal->edgeValid = false;
+
+    pI2cHal->i2cFd = open(pI2cHal->config.i2cDevice, O_RDWR | O_CLOEXEC);
+    if (pI2cHal->i2cFd < 0) {
+        return SH2_ERR_IO;
+    }
+
+    if (pI2cHal->config.gpioChip != 0) {
+        rc = requestLines(pI2cHal);
+    }
+    if (rc != SH2_OK) {
+        releaseLines(pI2cHal);
+        close(pI2cHal->i2cFd);
+        pI2cHal->i2cFd = -1;
+        return rc;
+    }
+
+    // Complete the reset cycle.  The hub asserts H_INTN once it has booted.
+    if (pI2cHal->resetFd >= 0) {
+        usleep(RESET_HOLD_US);
+        linux_gpioSet(pI2cHal->resetFd, false);
+    }
+
+    return SH2_OK;
+}
+
+static void i2cHalClose(sh2_Hal_t *self)
+{
+    linux_I2cHal_t *pI2cHal = (linux_I2cHal_t *)self;
+
+    // Leave the hub in reset
+    if (pI2cHal->resetFd >= 0) {
+        linux_gpioSet(pI2cHal->resetFd, true);
+    }
+
+    releaseLines(pI2cHal);
+
+    if (pI2cHal->i2cFd >= 0) {
+        close(pI2cHal->i2cFd);
+        pI2cHal->i2cFd = -1;
+    }
+}
+
+static int i2cHalReadTs(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint64_t *t_us)
+{
+    linux_I2cHal_t *pI2cHal = (linux_I2cHal_t *)self;
+    uint8_t hdr[SHTP_HDR_LEN];
+    unsigned rxLen;
+    unsigned cap;
+    int rc;
+
+    if (len < SHTP_HDR_LEN) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    // Without H_INTN, every read() polls the header.
+    if ((pI2cHal->intnFd >= 0) &&
+        !linux_gpioWaitAsserted(pI2cHal->intnFd, pI2cHal->config.waitMs,
+                                &pI2cHal->edge_ns, &pI2cHal->edgeValid)) {
+        return 0;
+    }
+
+    // Header phase: learn the length of the pending transfer.
+    rc = i2cXfer(pI2cHal, I2C_M_RD, hdr, SHTP_HDR_LEN);
+    if (rc != SH2_OK) {
+        pI2cHal->edgeValid = false;
+        return rc;
+    }
+    rxLen = (hdr[0] | (hdr[1] << 8)) & ~0x8000u;
+    if ((rxLen == 0) || ((hdr[0] == 0xFF) && (hdr[1] == 0xFF))) {
+        // Nothing to read.  The edge, if any, belonged to this poll.
+        pI2cHal->edgeValid = false;
+        return 0;
+    }
+    if (rxLen <= SHTP_HDR_LEN) {
+        // Header-only transfer, already complete.
+        memcpy(pBuffer, hdr, SHTP_HDR_LEN);
+        rc = SHTP_HDR_LEN;
+    }
+    else {
+        // Body phase: one read of exactly the announced length, capped to
+        // what the adapter and caller can take.  The hub sends any
+        // remainder as a continuation, announced by a new header.
+        cap = pI2cHal->config.maxTransfer ? pI2cHal->config.maxTransfer : SH2_HAL_MAX_TRANSFER_IN;
+        if (cap > len) {
+            cap = len;
+        }
+        if (rxLen > cap) {
+            rxLen = cap;
+            pI2cHal->cappedReads++;
+        }
+
+        rc = i2cXfer(pI2cHal, I2C_M_RD, pBuffer, rxLen);
+        if (rc != SH2_OK) {
+            pI2cHal->edgeValid = false;
+            return rc;
+        }
+        rc = rxLen;
+    }
+
+    pI2cHal->transfers++;
+
+    if (pI2cHal->edgeValid) {
+        // Kernel timestamp of the H_INTN edge
+        *t_us = pI2cHal->edge_ns / 1000;
+        pI2cHal->edgeValid = false;
+    }
+    else {
+        // H_INTN stayed asserted from the previous transfer
+        *t_us = nowUs();
+    }
+
+    return rc;
+}
+
+static int i2cHalRead(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us)
+{
+    uint64_t t64_us = 0;
+    int rc = i2cHalReadTs(self, pBuffer, len, &t64_us);
+
+    *t_us = (uint32_t)t64_us;
+
+    return rc;
+}
+
+static int i2cHalWrite(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len)
+{
+    linux_I2cHal_t *pI2cHal = (linux_I2cHal_t *)self;
+
+    if (len > SH2_HAL_MAX_TRANSFER_OUT) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    // The hub takes a whole transfer in one write transaction.
+    int rc = i2cXfer(pI2cHal, 0, pBuffer, len);
+    if (rc != SH2_OK) {
+        return rc;
+    }
+
+    return len;
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+sh2_Hal_t *linux_i2cHalInit(linux_I2cHal_t *pI2cHal, const linux_I2cHalConfig_t *pConfig)
+{
+    if ((pI2cHal == 0) || (pConfig == 0) || (pConfig->i2cDevice == 0)) {
+        return 0;
+    }
+
+    memset(pI2cHal, 0, sizeof(linux_I2cHal_t));
+    pI2cHal->config = *pConfig;
+    pI2cHal->i2cFd = -1;
+    pI2cHal->intnFd = -1;
+    pI2cHal->resetFd = -1;
+
+    pI2cHal->hal.open = i2cHalOpen;
+    pI2cHal->hal.close = i2cHalClose;
+    pI2cHal->hal.read = i2cHalRead;
+    pI2cHal->hal.write = i2cHalWrite;
+    pI2cHal->hal.getTimeUs = i2cHalGetTimeUs;
+    pI2cHal->hal.getPollFd = linux_i2cHalGetFd;
+    pI2cHal->hal.readTs = i2cHalReadTs;
+
+    return &pI2cHal->hal;
+}
+
+int linux_i2cHalGetFd(sh2_Hal_t *pHal)
+{
+    linux_I2cHal_t *pI2cHal = (linux_I2cHal_t *)pHal;
+
+    return pI2cHal->intnFd;
+}
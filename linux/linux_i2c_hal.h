@@ -0,0 +1,77 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Reference SH2 HAL for Linux hosts connected to the sensor hub via i2c-dev.
+ *
+ * Each transfer is read in two I2C_RDWR transactions: the 4-byte SHTP
+ * header, then one read sized to the length it announces.  The hub
+ * re-issues the header at the start of every read, so the second read
+ * holds a complete transfer.  Reads are capped at maxTransfer; when a
+ * transfer is longer than that, the hub sends the rest as continuation
+ * transfers, which the SHTP layer reassembles.
+ *
+ * As with the SPI HAL, H_INTN is monitored through the GPIO character
+ * device.  If gpioChip is NULL, read() polls the header instead.
+ */
+
+#ifndef LINUX_I2C_HAL_H
+#define LINUX_I2C_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sh2_hal.h"
+
+typedef struct linux_I2cHalConfig_s {
+    const char *i2cDevice;  // i2c-dev node, e.g. "/dev/i2c-1"
+    uint16_t address;       // 7-bit hub address, 0x4A or 0x4B
+    unsigned maxTransfer;   // Largest read the adapter supports. (0: SH2_HAL_MAX_TRANSFER_IN)
+    const char *gpioChip;   // GPIO chip for the lines below, e.g. "/dev/gpiochip0"
+    unsigned intnLine;      // H_INTN line offset
+    int resetLine;          // NRST line offset, -1 if not connected
+    int waitMs;             // Max time read() blocks for H_INTN. (0: never block,
+                            // required when driven by sh2_onReadable())
+} linux_I2cHalConfig_t;
+
+typedef struct linux_I2cHal_s {
+    sh2_Hal_t hal;          // Must be first: pointer is passed to sh2_open()
+    linux_I2cHalConfig_t config;
+
+    int i2cFd;
+    int intnFd;
+    int resetFd;
+
+    // Timestamp of the H_INTN edge not yet matched with a transfer
+    bool edgeValid;
+    uint64_t edge_ns;
+
+    // Stats
+    uint32_t transfers;
+    uint32_t cappedReads;
+    uint32_t ioErrors;
+} linux_I2cHal_t;
+
+// Initialize an I2C HAL instance.  No devices are opened until sh2_open()
+// calls the HAL's open function.  Returns the sh2_Hal_t to pass to sh2_open().
+sh2_Hal_t *linux_i2cHalInit(linux_I2cHal_t *pI2cHal, const linux_I2cHalConfig_t *pConfig);
+
+// Get the fd that becomes readable when H_INTN is asserted, for use with
+// poll() or epoll.  Returns -1 if the HAL is not open or has no H_INTN line.
+int linux_i2cHalGetFd(sh2_Hal_t *pHal);
+
+#endif
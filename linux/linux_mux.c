@@ -0,0 +1,485 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Sharing one sensor hub among many local clients.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     // accept4
+#endif
+
+#include "linux_mux.h"
+#include "sh2_err.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// ------------------------------------------------------------------------
+// Private definitions
+
+// Longest wait between sh2_service() calls for HALs without a poll fd
+#define POLL_SERVICE_MS (1)
+
+// ------------------------------------------------------------------------
+// Private functions
+
+static void flushClient(linux_MuxClient_t *pClient)
+{
+    if (pClient->batchLen == 0) {
+        return;
+    }
+
+    ssize_t rc = send(pClient->fd, pClient->batch,
+                      pClient->batchLen * sizeof(linux_MuxRecord_t),
+                      MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (rc < 0) {
+        // Slow or departed client.  Departures are noticed by poll().
+        pClient->droppedRecords += pClient->batchLen;
+    }
+    else {
+        pClient->delivered += pClient->batchLen;
+    }
+    pClient->batchLen = 0;
+}
+
+static linux_MuxRecord_t *nextRecord(linux_MuxClient_t *pClient)
+{
+    if (pClient->batchLen == LINUX_MUX_BATCH) {
+        flushClient(pClient);
+    }
+
+    return &pClient->batch[pClient->batchLen++];
+}
+
+// Configure a sensor at the fastest interval any client wants.
+static int applySensor(linux_MuxServer_t *pServer, uint8_t sensorId)
+{
+    uint32_t interval_us = 0;
+    sh2_SensorConfig_t config;
+    int rc;
+
+    for (unsigned n = 0; n < LINUX_MUX_MAX_CLIENTS; n++) {
+        const linux_MuxClient_t *pClient = &pServer->client[n];
+        uint32_t want = pClient->sub[sensorId].interval_us;
+
+        if ((pClient->fd >= 0) && (want != 0) &&
+            ((interval_us == 0) || (want < interval_us))) {
+            interval_us = want;
+        }
+    }
+
+    if (interval_us == pServer->applied_us[sensorId]) {
+        return SH2_OK;
+    }
+
+    memset(&config, 0, sizeof(config));
+    config.reportInterval_us = interval_us;
+    rc = sh2_setSensorConfig(sensorId, &config);
+    if (rc != SH2_OK) {
+        pServer->configErrors++;
+        return rc;
+    }
+    pServer->applied_us[sensorId] = interval_us;
+
+    return SH2_OK;
+}
+
+static void closeClient(linux_MuxServer_t *pServer, linux_MuxClient_t *pClient)
+{
+    close(pClient->fd);
+    pClient->fd = -1;
+    pClient->batchLen = 0;
+
+    for (unsigned id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+        if (pClient->sub[id].interval_us != 0) {
+            pClient->sub[id].interval_us = 0;
+            applySensor(pServer, id);
+        }
+    }
+}
+
+static void handleRequest(linux_MuxServer_t *pServer, linux_MuxClient_t *pClient,
+                          const linux_MuxRequest_t *pReq)
+{
+    linux_MuxRecord_t *pStatus;
+    int rc = SH2_OK;
+
+    if (pReq->sensorId > SH2_MAX_SENSOR_ID) {
+        rc = SH2_ERR_BAD_PARAM;
+    }
+    else if (pReq->op == LINUX_MUX_SUBSCRIBE) {
+        linux_MuxSub_t *pSub = &pClient->sub[pReq->sensorId];
+
+        pSub->interval_us = pReq->interval_us;
+        pSub->flags = pReq->flags;
+        pSub->due = true;
+        rc = applySensor(pServer, pReq->sensorId);
+    }
+    else if (pReq->op == LINUX_MUX_UNSUBSCRIBE) {
+        pClient->sub[pReq->sensorId].interval_us = 0;
+        rc = applySensor(pServer, pReq->sensorId);
+    }
+    else {
+        rc = SH2_ERR_BAD_PARAM;
+    }
+
+    pStatus = nextRecord(pClient);
+    memset(pStatus, 0, sizeof(linux_MuxRecord_t));
+    pStatus->kind = LINUX_MUX_STATUS;
+    pStatus->sensorId = pReq->sensorId;
+    pStatus->status = rc;
+}
+
+// Returns false if the client went away.
+static bool readClient(linux_MuxServer_t *pServer, linux_MuxClient_t *pClient)
+{
+    linux_MuxRequest_t req;
+
+    for (;;) {
+        ssize_t rc = recv(pClient->fd, &req, sizeof(req), MSG_DONTWAIT);
+
+        if (rc == sizeof(req)) {
+            handleRequest(pServer, pClient, &req);
+        }
+        else if (rc > 0) {
+            // Malformed request: ignore it.
+        }
+        else if ((rc < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+            return true;
+        }
+        else {
+            // EOF or error
+            return false;
+        }
+    }
+}
+
+static void acceptClients(linux_MuxServer_t *pServer)
+{
+    for (;;) {
+        int fd = accept4(pServer->listenFd, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        linux_MuxClient_t *pClient = 0;
+        for (unsigned n = 0; n < LINUX_MUX_MAX_CLIENTS; n++) {
+            if (pServer->client[n].fd < 0) {
+                pClient = &pServer->client[n];
+                break;
+            }
+        }
+        if (pClient == 0) {
+            // No room
+            close(fd);
+            continue;
+        }
+
+        memset(pClient, 0, sizeof(linux_MuxClient_t));
+        pClient->fd = fd;
+    }
+}
+
+// Decide whether a client gets this event, keeping its own cadence.
+static bool decimate(linux_MuxSub_t *pSub, uint64_t t_us)
+{
+    uint32_t interval_us = pSub->interval_us;
+
+    // Allow an eighth of an interval of jitter
+    if (!pSub->due && (t_us + interval_us / 8 < pSub->nextDue_us)) {
+        return false;
+    }
+
+    if (pSub->due || (t_us > pSub->nextDue_us + interval_us)) {
+        // First event, or fell behind: restart the cadence here.
+        pSub->nextDue_us = t_us + interval_us;
+    }
+    else {
+        pSub->nextDue_us += interval_us;
+    }
+    pSub->due = false;
+
+    return true;
+}
+
+static void sensorCallback(void *cookie, sh2_SensorEvent_t *pEvent)
+{
+    linux_MuxServer_t *pServer = (linux_MuxServer_t *)cookie;
+    uint8_t sensorId = pEvent->reportId;
+    sh2_SensorValue_t value;
+    bool decoded = false;
+
+    if (sensorId > SH2_MAX_SENSOR_ID) {
+        return;
+    }
+
+    for (unsigned n = 0; n < LINUX_MUX_MAX_CLIENTS; n++) {
+        linux_MuxClient_t *pClient = &pServer->client[n];
+        linux_MuxSub_t *pSub = &pClient->sub[sensorId];
+
+        if ((pClient->fd < 0) || (pSub->interval_us == 0) ||
+            !decimate(pSub, pEvent->timestamp_uS)) {
+            continue;
+        }
+
+        if (pSub->flags & LINUX_MUX_FLAG_DECODED) {
+            // Decode once for all clients that want it.
+            if (!decoded) {
+                if (sh2_decodeSensorEvent(&value, pEvent) != SH2_OK) {
+                    pServer->decodeErrors++;
+                    continue;
+                }
+                decoded = true;
+            }
+            linux_MuxRecord_t *pRec = nextRecord(pClient);
+            pRec->kind = LINUX_MUX_DECODED;
+            pRec->sensorId = sensorId;
+            pRec->status = SH2_OK;
+            pRec->u.value = value;
+        }
+        else {
+            linux_MuxRecord_t *pRec = nextRecord(pClient);
+            pRec->kind = LINUX_MUX_RAW;
+            pRec->sensorId = sensorId;
+            pRec->status = SH2_OK;
+            pRec->u.raw = *pEvent;
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+int linux_muxServerInit(linux_MuxServer_t *pServer, const char *path)
+{
+    struct sockaddr_un addr;
+
+    if ((pServer == 0) || (path == 0) || (strlen(path) >= sizeof(addr.sun_path))) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    memset(pServer, 0, sizeof(linux_MuxServer_t));
+    for (unsigned n = 0; n < LINUX_MUX_MAX_CLIENTS; n++) {
+        pServer->client[n].fd = -1;
+    }
+
+    pServer->listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (pServer->listenFd < 0) {
+        return SH2_ERR_IO;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+    if ((bind(pServer->listenFd, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+        (listen(pServer->listenFd, LINUX_MUX_MAX_CLIENTS) < 0)) {
+        close(pServer->listenFd);
+        pServer->listenFd = -1;
+        return SH2_ERR_IO;
+    }
+
+    return sh2_setSensorCallback(sensorCallback, pServer);
+}
+
+void linux_muxServerDeinit(linux_MuxServer_t *pServer)
+{
+    for (unsigned n = 0; n < LINUX_MUX_MAX_CLIENTS; n++) {
+        if (pServer->client[n].fd >= 0) {
+            closeClient(pServer, &pServer->client[n]);
+        }
+    }
+
+    if (pServer->listenFd >= 0) {
+        close(pServer->listenFd);
+        pServer->listenFd = -1;
+    }
+}
+
+void linux_muxServerOnReset(linux_MuxServer_t *pServer)
+{
+    // Can't configure from inside a callback: defer to the service call.
+    memset(pServer->applied_us, 0, sizeof(pServer->applied_us));
+    pServer->reapply = true;
+}
+
+int linux_muxServerService(linux_MuxServer_t *pServer, int timeout_ms)
+{
+    struct pollfd pfd[2 + LINUX_MUX_MAX_CLIENTS];
+    linux_MuxClient_t *pClientOf[2 + LINUX_MUX_MAX_CLIENTS];
+    unsigned nfds = 0;
+    int hubFd = sh2_getPollFd();
+    uint32_t delay_us;
+    int rc = SH2_OK;
+
+    pfd[nfds].fd = pServer->listenFd;
+    pfd[nfds].events = POLLIN;
+    pClientOf[nfds++] = 0;
+    if (hubFd >= 0) {
+        pfd[nfds].fd = hubFd;
+        pfd[nfds].events = POLLIN;
+        pClientOf[nfds++] = 0;
+    }
+    else if ((timeout_ms < 0) || (timeout_ms > POLL_SERVICE_MS)) {
+        // The hub has to be polled.
+        timeout_ms = POLL_SERVICE_MS;
+    }
+    if (sh2_nextServiceDelay(&delay_us) == SH2_OK) {
+        // sh2 timers run from sh2_service() even with no hub data.
+        int delay_ms = (int)((delay_us + 999) / 1000);
+        if ((timeout_ms < 0) || (delay_ms < timeout_ms)) {
+            timeout_ms = delay_ms;
+        }
+    }
+    if (pServer->hubPending) {
+        // No new edge will come for data already waiting.
+        timeout_ms = 0;
+    }
+    for (unsigned n = 0; n < LINUX_MUX_MAX_CLIENTS; n++) {
+        if (pServer->client[n].fd >= 0) {
+            pfd[nfds].fd = pServer->client[n].fd;
+            pfd[nfds].events = POLLIN;
+            pClientOf[nfds++] = &pServer->client[n];
+        }
+    }
+
+    if (poll(pfd, nfds, timeout_ms) < 0) {
+        if (errno != EINTR) {
+            return SH2_ERR_IO;
+        }
+        return SH2_OK;
+    }
+
+    // Hub first, so fresh data goes out before slower client handling.
+    if (hubFd < 0) {
+        sh2_service();
+    }
+    else if ((pfd[1].revents != 0) || pServer->hubPending) {
+        int transfers = sh2_onReadable();
+        if (transfers < 0) {
+            rc = SH2_ERR_IO;
+        }
+        pServer->hubPending = (transfers == SH2_MAX_READS_PER_SERVICE);
+    }
+    else if ((sh2_nextServiceDelay(&delay_us) == SH2_OK) && (delay_us == 0)) {
+        sh2_service();
+    }
+
+    if (pServer->reapply) {
+        pServer->reapply = false;
+        for (unsigned id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+            applySensor(pServer, id);
+        }
+    }
+
+    for (unsigned n = 0; n < nfds; n++) {
+        linux_MuxClient_t *pClient = pClientOf[n];
+
+        if ((pClient != 0) && (pfd[n].revents != 0) && !readClient(pServer, pClient)) {
+            closeClient(pServer, pClient);
+        }
+    }
+
+    if (pfd[0].revents & POLLIN) {
+        acceptClients(pServer);
+    }
+
+    for (unsigned n = 0; n < LINUX_MUX_MAX_CLIENTS; n++) {
+        if (pServer->client[n].fd >= 0) {
+            flushClient(&pServer->client[n]);
+        }
+    }
+
+    return rc;
+}
+
+int linux_muxConnect(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    if ((path == 0) || (strlen(path) >= sizeof(addr.sun_path))) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return SH2_ERR_IO;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return SH2_ERR_IO;
+    }
+
+    return fd;
+}
+
+static int sendRequest(int fd, uint8_t op, uint8_t sensorId, uint32_t interval_us, uint8_t flags)
+{
+    linux_MuxRequest_t req;
+
+    memset(&req, 0, sizeof(req));
+    req.op = op;
+    req.sensorId = sensorId;
+    req.flags = flags;
+    req.interval_us = interval_us;
+
+    if (send(fd, &req, sizeof(req), MSG_NOSIGNAL) != sizeof(req)) {
+        return SH2_ERR_IO;
+    }
+
+    return SH2_OK;
+}
+
+int linux_muxSubscribe(int fd, uint8_t sensorId, uint32_t interval_us, bool decoded)
+{
+    if (interval_us == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    return sendRequest(fd, LINUX_MUX_SUBSCRIBE, sensorId, interval_us,
+                       decoded ? LINUX_MUX_FLAG_DECODED : 0);
+}
+
+int linux_muxUnsubscribe(int fd, uint8_t sensorId)
+{
+    return sendRequest(fd, LINUX_MUX_UNSUBSCRIBE, sensorId, 0, 0);
+}
+
+int linux_muxReceive(int fd, linux_MuxRecord_t *pRecords, unsigned maxRecords)
+{
+    ssize_t rc = recv(fd, pRecords, maxRecords * sizeof(linux_MuxRecord_t), 0);
+
+    if (rc < 0) {
+        return ((errno == EAGAIN) || (errno == EWOULDBLOCK)) ? 0 : SH2_ERR_IO;
+    }
+    if (rc == 0) {
+        // Server went away
+        return SH2_ERR_IO;
+    }
+
+    return rc / sizeof(linux_MuxRecord_t);
+}
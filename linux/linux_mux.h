@@ -0,0 +1,141 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Sharing one sensor hub among many local clients.
+ *
+ * The server side runs in the process that owns the hub (see sh2_muxd.c).
+ * Clients connect to its Unix-domain socket (SOCK_SEQPACKET) and send
+ * linux_MuxRequest_t messages to subscribe to sensors at the rate they
+ * want.  The server configures each sensor at the fastest rate any
+ * client asked for and decimates the stream separately for each client.
+ *
+ * Events reach clients in batches of linux_MuxRecord_t, one batch per
+ * message.  The server never blocks on a client: a batch a client's
+ * socket can't take is dropped and counted.
+ */
+
+#ifndef LINUX_MUX_H
+#define LINUX_MUX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sh2.h"
+#include "sh2_SensorValue.h"
+
+#define LINUX_MUX_MAX_CLIENTS (16)
+#define LINUX_MUX_BATCH       (16)    // Records per message, at most
+
+// ------------------------------------------------------------------------
+// Wire format, host byte order
+
+#define LINUX_MUX_SUBSCRIBE   (1)
+#define LINUX_MUX_UNSUBSCRIBE (2)
+
+#define LINUX_MUX_FLAG_DECODED (0x01)   // Deliver sh2_SensorValue_t, not raw events
+
+typedef struct linux_MuxRequest_s {
+    uint8_t op;             // LINUX_MUX_SUBSCRIBE or LINUX_MUX_UNSUBSCRIBE
+    uint8_t sensorId;
+    uint8_t flags;          // LINUX_MUX_FLAG_...
+    uint8_t reserved;
+    uint32_t interval_us;   // Requested report interval
+} linux_MuxRequest_t;
+
+#define LINUX_MUX_RAW     (1)
+#define LINUX_MUX_DECODED (2)
+#define LINUX_MUX_STATUS  (3)   // Result of a request
+
+typedef struct linux_MuxRecord_s {
+    uint8_t kind;           // LINUX_MUX_RAW, _DECODED or _STATUS
+    uint8_t sensorId;
+    int16_t status;         // STATUS: SH2_OK or a value from sh2_err.h
+    union {
+        sh2_SensorEvent_t raw;
+        sh2_SensorValue_t value;
+    } u;
+} linux_MuxRecord_t;
+
+// ------------------------------------------------------------------------
+// Server
+
+typedef struct linux_MuxSub_s {
+    uint32_t interval_us;   // 0: not subscribed
+    uint8_t flags;
+    bool due;               // Deliver the next event regardless of time
+    uint64_t nextDue_us;
+} linux_MuxSub_t;
+
+typedef struct linux_MuxClient_s {
+    int fd;                 // -1: slot free
+    linux_MuxSub_t sub[SH2_MAX_SENSOR_ID + 1];
+    linux_MuxRecord_t batch[LINUX_MUX_BATCH];
+    unsigned batchLen;
+
+    // Stats
+    uint32_t delivered;     // Records sent
+    uint32_t droppedRecords;
+} linux_MuxClient_t;
+
+typedef struct linux_MuxServer_s {
+    int listenFd;
+    linux_MuxClient_t client[LINUX_MUX_MAX_CLIENTS];
+
+    // Report interval currently configured on the hub, 0 if off.
+    uint32_t applied_us[SH2_MAX_SENSOR_ID + 1];
+    bool reapply;           // Hub was reset: configure every sensor again
+    bool hubPending;        // Hub may have more transfers waiting
+
+    // Stats
+    uint32_t configErrors;
+    uint32_t decodeErrors;
+} linux_MuxServer_t;
+
+// Listen on path.  The sh2 session must already be open; this installs
+// the server's sensor callback.
+int linux_muxServerInit(linux_MuxServer_t *pServer, const char *path);
+
+// Disconnect every client, turn off the sensors they used and stop listening.
+void linux_muxServerDeinit(linux_MuxServer_t *pServer);
+
+// Call from the sh2 event callback on SH2_RESET.  The hub loses sensor
+// configuration on reset; the next service call restores it.
+void linux_muxServerOnReset(linux_MuxServer_t *pServer);
+
+// Wait up to timeout_ms for hub data or client activity and handle it.
+int linux_muxServerService(linux_MuxServer_t *pServer, int timeout_ms);
+
+// ------------------------------------------------------------------------
+// Client
+
+// Connect to a server.  Returns the socket fd or a negative value from sh2_err.h.
+int linux_muxConnect(const char *path);
+
+// Subscribe to a sensor, or change the rate of an existing subscription.
+// The server replies with a LINUX_MUX_STATUS record.
+int linux_muxSubscribe(int fd, uint8_t sensorId, uint32_t interval_us, bool decoded);
+
+int linux_muxUnsubscribe(int fd, uint8_t sensorId);
+
+// Receive one batch.  Blocks unless the socket is non-blocking.
+// maxRecords should be LINUX_MUX_BATCH: records beyond it are discarded.
+// Returns the number of records stored, 0 if none were waiting on a
+// non-blocking socket, or a negative value from sh2_err.h.
+int linux_muxReceive(int fd, linux_MuxRecord_t *pRecords, unsigned maxRecords);
+
+#endif
@@ -0,0 +1,564 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Reactor servicing many sensor hubs from one epoll set.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     // pthread_setaffinity_np
+#endif
+
+#include "linux_reactor.h"
+#include "sh2.h"
+#include "sh2_err.h"
+
+#include <limits.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+// ------------------------------------------------------------------------
+// Private definitions
+
+#define DEFAULT_BUDGET (4)
+
+// epoll data value identifying a shard's stop eventfd
+#define STOP_TAG ((void *)0)
+
+// ------------------------------------------------------------------------
+// Private functions
+
+static uint64_t nowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+static void recordTime(uint32_t t_us, uint32_t *pLast, uint32_t *pMax, uint64_t *pTotal)
+{
+    *pLast = t_us;
+    if (t_us > *pMax) {
+        *pMax = t_us;
+    }
+    *pTotal += t_us;
+}
+
+static void shardDeinit(linux_ReactorShard_t *pShard)
+{
+    if (pShard->epfd >= 0) {
+        close(pShard->epfd);
+        pShard->epfd = -1;
+    }
+    if (pShard->stopFd >= 0) {
+        close(pShard->stopFd);
+        pShard->stopFd = -1;
+    }
+    pthread_mutex_destroy(&pShard->statsLock);
+}
+
+static int shardInit(linux_ReactorShard_t *pShard, linux_Reactor_t *pReactor, int cpu)
+{
+    struct epoll_event ev;
+
+    memset(pShard, 0, sizeof(linux_ReactorShard_t));
+    pShard->pReactor = pReactor;
+    pShard->cpu = cpu;
+    pShard->epfd = -1;
+    pShard->stopFd = -1;
+    pthread_mutex_init(&pShard->statsLock, 0);
+
+    pShard->epfd = epoll_create1(EPOLL_CLOEXEC);
+    pShard->stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if ((pShard->epfd < 0) || (pShard->stopFd < 0)) {
+        shardDeinit(pShard);
+        return SH2_ERR;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = STOP_TAG;
+    if (epoll_ctl(pShard->epfd, EPOLL_CTL_ADD, pShard->stopFd, &ev) < 0) {
+        shardDeinit(pShard);
+        return SH2_ERR;
+    }
+
+    return SH2_OK;
+}
+
+// Service the busy hubs round-robin, at most budget calls each.
+static int serviceBusy(linux_ReactorShard_t *pShard)
+{
+    unsigned budget = pShard->pReactor->config.budget;
+    int calls = 0;
+
+    while (pShard->busyCount != 0) {
+        unsigned kept = 0;
+
+        for (unsigned n = 0; n < pShard->busyCount; n++) {
+            linux_ReactorHub_t *pHub = pShard->busy[n];
+            uint64_t start_us = nowUs();
+            int rc = pHub->service(pHub->cookie);
+            uint64_t end_us = nowUs();
+            bool done = (rc <= 0);
+
+            calls++;
+            pHub->calls++;
+
+            pthread_mutex_lock(&pShard->statsLock);
+            pHub->stats.services++;
+            if (!pHub->serviced) {
+                pHub->serviced = true;
+                recordTime((uint32_t)(start_us - pHub->ready_us), &pHub->stats.lastQueue_us,
+                           &pHub->stats.maxQueue_us, &pHub->stats.totalQueue_us);
+            }
+            if (rc < 0) {
+                pHub->stats.errors++;
+            }
+            if (done) {
+                recordTime((uint32_t)(end_us - pHub->ready_us), &pHub->stats.lastDrain_us,
+                           &pHub->stats.maxDrain_us, &pHub->stats.totalDrain_us);
+            }
+            else if (pHub->calls >= budget) {
+                pHub->stats.budgetHits++;
+            }
+            pthread_mutex_unlock(&pShard->statsLock);
+
+            if (done) {
+                pHub->busy = false;
+                continue;
+            }
+            if (pHub->calls >= budget) {
+                // Yield to other hubs; resume on the next pass.
+                pHub->calls = 0;
+            }
+            pShard->busy[kept++] = pHub;
+        }
+
+        pShard->busyCount = kept;
+
+        // Stop once every remaining hub has used its budget.
+        bool allYielded = true;
+        for (unsigned n = 0; n < pShard->busyCount; n++) {
+            if (pShard->busy[n]->calls != 0) {
+                allYielded = false;
+                break;
+            }
+        }
+        if (allYielded) {
+            break;
+        }
+    }
+
+    return calls;
+}
+
+// Ask the shard's hubs when their timers are due.  Returns timeout_ms,
+// shortened to the earliest of them.
+static int armTimers(linux_ReactorShard_t *pShard, int timeout_ms)
+{
+    linux_Reactor_t *pReactor = pShard->pReactor;
+    unsigned shard = (unsigned)(pShard - pReactor->shard);
+    uint64_t now_us = nowUs();
+
+    for (unsigned id = 0; id < LINUX_REACTOR_MAX_HUBS; id++) {
+        linux_ReactorHub_t *pHub = &pReactor->hub[id];
+
+        if (!pHub->inUse || (pHub->shard != shard) || (pHub->delay == 0)) {
+            continue;
+        }
+
+        int64_t delay_us = pHub->delay(pHub->cookie);
+        pHub->timerArmed = (delay_us >= 0);
+        if (!pHub->timerArmed) {
+            continue;
+        }
+        pHub->due_us = now_us + delay_us;
+
+        // Round up: waking before the timer is due would only spin.
+        int64_t delay_ms = (delay_us + 999) / 1000;
+        if (delay_ms > INT_MAX) {
+            delay_ms = INT_MAX;
+        }
+        if ((timeout_ms < 0) || (delay_ms < timeout_ms)) {
+            timeout_ms = (int)delay_ms;
+        }
+    }
+
+    return timeout_ms;
+}
+
+// Call expire() for the timers that are due.  Returns the number of calls.
+static int runTimers(linux_ReactorShard_t *pShard)
+{
+    linux_Reactor_t *pReactor = pShard->pReactor;
+    unsigned shard = (unsigned)(pShard - pReactor->shard);
+    uint64_t now_us = nowUs();
+    int calls = 0;
+
+    for (unsigned id = 0; id < LINUX_REACTOR_MAX_HUBS; id++) {
+        linux_ReactorHub_t *pHub = &pReactor->hub[id];
+
+        if (!pHub->inUse || (pHub->shard != shard) || !pHub->timerArmed ||
+            (now_us < pHub->due_us)) {
+            continue;
+        }
+
+        pHub->timerArmed = false;
+        int rc = pHub->expire(pHub->cookie);
+        calls++;
+
+        pthread_mutex_lock(&pShard->statsLock);
+        pHub->stats.timeouts++;
+        if (rc < 0) {
+            pHub->stats.errors++;
+        }
+        pthread_mutex_unlock(&pShard->statsLock);
+    }
+
+    return calls;
+}
+
+static int shardRun(linux_ReactorShard_t *pShard, int timeout_ms, bool *pStop)
+{
+    struct epoll_event events[LINUX_REACTOR_MAX_HUBS + 1];
+    int n;
+
+    timeout_ms = armTimers(pShard, timeout_ms);
+
+    // Hubs left over from the last pass still have data: don't sleep.
+    if (pShard->busyCount != 0) {
+        timeout_ms = 0;
+    }
+
+    n = epoll_wait(pShard->epfd, events, LINUX_REACTOR_MAX_HUBS + 1, timeout_ms);
+    if (n < 0) {
+        n = 0;  // EINTR: just service what is pending
+    }
+
+    uint64_t ready_us = nowUs();
+    for (int i = 0; i < n; i++) {
+        linux_ReactorHub_t *pHub = (linux_ReactorHub_t *)events[i].data.ptr;
+
+        if (pHub == STOP_TAG) {
+            *pStop = true;
+            continue;
+        }
+
+        pthread_mutex_lock(&pShard->statsLock);
+        pHub->stats.wakeups++;
+        pthread_mutex_unlock(&pShard->statsLock);
+
+        if (!pHub->busy) {
+            pHub->busy = true;
+            pHub->serviced = false;
+            pHub->calls = 0;
+            pHub->ready_us = ready_us;
+            pShard->busy[pShard->busyCount++] = pHub;
+        }
+    }
+
+    int calls = serviceBusy(pShard);
+
+    return calls + runTimers(pShard);
+}
+
+static void *workerMain(void *arg)
+{
+    linux_ReactorShard_t *pShard = (linux_ReactorShard_t *)arg;
+    bool stop = false;
+
+    if (pShard->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(pShard->cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    while (!stop) {
+        shardRun(pShard, -1, &stop);
+    }
+
+    return 0;
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+int linux_reactorInit(linux_Reactor_t *pReactor, const linux_ReactorConfig_t *pConfig)
+{
+    if ((pReactor == 0) || (pConfig == 0) ||
+        (pConfig->workers > LINUX_REACTOR_MAX_WORKERS)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    memset(pReactor, 0, sizeof(linux_Reactor_t));
+    pReactor->config = *pConfig;
+    if (pReactor->config.budget == 0) {
+        pReactor->config.budget = DEFAULT_BUDGET;
+    }
+
+    pReactor->shards = pConfig->workers ? pConfig->workers : 1;
+    for (unsigned n = 0; n < pReactor->shards; n++) {
+        int cpu = pConfig->workers ? pConfig->cpu[n] : -1;
+        if (shardInit(&pReactor->shard[n], pReactor, cpu) != SH2_OK) {
+            while (n-- > 0) {
+                shardDeinit(&pReactor->shard[n]);
+            }
+            return SH2_ERR;
+        }
+    }
+
+    return SH2_OK;
+}
+
+void linux_reactorDeinit(linux_Reactor_t *pReactor)
+{
+    linux_reactorStop(pReactor);
+
+    for (unsigned n = 0; n < pReactor->shards; n++) {
+        shardDeinit(&pReactor->shard[n]);
+    }
+    pReactor->shards = 0;
+}
+
+int linux_reactorAdd(linux_Reactor_t *pReactor, int fd,
+                     linux_ReactorService_t *service, void *cookie)
+{
+    struct epoll_event ev;
+    int id;
+    unsigned shard = 0;
+
+    if ((fd < 0) || (service == 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    for (id = 0; id < LINUX_REACTOR_MAX_HUBS; id++) {
+        if (!pReactor->hub[id].inUse) {
+            break;
+        }
+    }
+    if (id >= LINUX_REACTOR_MAX_HUBS) {
+        return SH2_ERR;
+    }
+
+    // Least loaded shard
+    for (unsigned n = 1; n < pReactor->shards; n++) {
+        if (pReactor->shard[n].hubs < pReactor->shard[shard].hubs) {
+            shard = n;
+        }
+    }
+
+    linux_ReactorHub_t *pHub = &pReactor->hub[id];
+    memset(pHub, 0, sizeof(linux_ReactorHub_t));
+    pHub->fd = fd;
+    pHub->service = service;
+    pHub->cookie = cookie;
+    pHub->shard = shard;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = pHub;
+    if (epoll_ctl(pReactor->shard[shard].epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        return SH2_ERR_IO;
+    }
+
+    pHub->inUse = true;
+    pReactor->shard[shard].hubs++;
+
+    return id;
+}
+
+int linux_reactorRemove(linux_Reactor_t *pReactor, int hubId)
+{
+    if ((hubId < 0) || (hubId >= LINUX_REACTOR_MAX_HUBS) || !pReactor->hub[hubId].inUse) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    linux_ReactorHub_t *pHub = &pReactor->hub[hubId];
+    linux_ReactorShard_t *pShard = &pReactor->shard[pHub->shard];
+
+    if (pHub->fd >= 0) {
+        epoll_ctl(pShard->epfd, EPOLL_CTL_DEL, pHub->fd, 0);
+    }
+
+    // Drop from the busy list, keeping order
+    unsigned kept = 0;
+    for (unsigned n = 0; n < pShard->busyCount; n++) {
+        if (pShard->busy[n] != pHub) {
+            pShard->busy[kept++] = pShard->busy[n];
+        }
+    }
+    pShard->busyCount = kept;
+
+    pHub->inUse = false;
+    pShard->hubs--;
+
+    return SH2_OK;
+}
+
+int linux_reactorSetFd(linux_Reactor_t *pReactor, int hubId, int fd)
+{
+    struct epoll_event ev;
+
+    if ((hubId < 0) || (hubId >= LINUX_REACTOR_MAX_HUBS) || !pReactor->hub[hubId].inUse) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    linux_ReactorHub_t *pHub = &pReactor->hub[hubId];
+    linux_ReactorShard_t *pShard = &pReactor->shard[pHub->shard];
+
+    // epoll_ctl() is safe against a worker waiting on the same set.  A
+    // descriptor already closed has left the set by itself.
+    if (pHub->fd >= 0) {
+        epoll_ctl(pShard->epfd, EPOLL_CTL_DEL, pHub->fd, 0);
+    }
+    pHub->fd = -1;
+
+    if (fd >= 0) {
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = pHub;
+        if (epoll_ctl(pShard->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            return SH2_ERR_IO;
+        }
+        pHub->fd = fd;
+    }
+
+    return SH2_OK;
+}
+
+int linux_reactorSetTimer(linux_Reactor_t *pReactor, int hubId,
+                          linux_ReactorDelay_t *delay, linux_ReactorService_t *expire)
+{
+    if ((hubId < 0) || (hubId >= LINUX_REACTOR_MAX_HUBS) || !pReactor->hub[hubId].inUse ||
+        ((delay != 0) && (expire == 0))) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    linux_ReactorHub_t *pHub = &pReactor->hub[hubId];
+
+    pHub->delay = delay;
+    pHub->expire = expire;
+    pHub->timerArmed = false;
+
+    return SH2_OK;
+}
+
+int linux_reactorRun(linux_Reactor_t *pReactor, int timeout_ms)
+{
+    bool stop = false;
+
+    if (pReactor->config.workers != 0) {
+        // Workers own the shards.
+        return SH2_ERR;
+    }
+
+    return shardRun(&pReactor->shard[0], timeout_ms, &stop);
+}
+
+int linux_reactorStart(linux_Reactor_t *pReactor)
+{
+    if (pReactor->config.workers == 0) {
+        return SH2_ERR;
+    }
+
+    for (unsigned n = 0; n < pReactor->shards; n++) {
+        linux_ReactorShard_t *pShard = &pReactor->shard[n];
+        uint64_t drain;
+
+        // Clear any stale stop request
+        while (read(pShard->stopFd, &drain, sizeof(drain)) > 0) {
+        }
+
+        if (pthread_create(&pShard->thread, 0, workerMain, pShard) != 0) {
+            linux_reactorStop(pReactor);
+            return SH2_ERR;
+        }
+        pShard->running = true;
+    }
+
+    return SH2_OK;
+}
+
+void linux_reactorStop(linux_Reactor_t *pReactor)
+{
+    for (unsigned n = 0; n < pReactor->shards; n++) {
+        linux_ReactorShard_t *pShard = &pReactor->shard[n];
+        uint64_t one = 1;
+
+        if (pShard->running) {
+            if (write(pShard->stopFd, &one, sizeof(one)) < 0) {
+                // eventfd write only fails on counter overflow
+            }
+            pthread_join(pShard->thread, 0);
+            pShard->running = false;
+        }
+    }
+}
+
+int linux_reactorGetStats(linux_Reactor_t *pReactor, int hubId, linux_ReactorHubStats_t *pStats)
+{
+    if ((hubId < 0) || (hubId >= LINUX_REACTOR_MAX_HUBS) ||
+        !pReactor->hub[hubId].inUse || (pStats == 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    linux_ReactorHub_t *pHub = &pReactor->hub[hubId];
+    linux_ReactorShard_t *pShard = &pReactor->shard[pHub->shard];
+
+    pthread_mutex_lock(&pShard->statsLock);
+    *pStats = pHub->stats;
+    pthread_mutex_unlock(&pShard->statsLock);
+
+    return SH2_OK;
+}
+
+int linux_reactorServiceSh2(void *cookie)
+{
+    (void)cookie; // unused
+
+    return sh2_onReadable();
+}
+
+int64_t linux_reactorDelaySh2(void *cookie)
+{
+    uint32_t delay_us;
+
+    (void)cookie; // unused
+
+    if (sh2_nextServiceDelay(&delay_us) != SH2_OK) {
+        return -1;  // Closed: nothing is due
+    }
+
+    return delay_us;
+}
+
+int linux_reactorExpireSh2(void *cookie)
+{
+    (void)cookie; // unused
+
+    sh2_service();
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Reactor servicing many sensor hubs from one epoll set.
+ *
+ * Each hub is registered with the descriptor that becomes readable when
+ * it has data (see sh2_getPollFd()) and a service function that handles
+ * one batch of its data without blocking (see sh2_onReadable()).  When a
+ * hub's descriptor becomes readable, it is serviced round-robin with the
+ * other ready hubs until it reports no more work or its fairness budget
+ * for this wakeup is used; in the latter case it is resumed on the next
+ * pass without waiting for another readiness event.
+ *
+ * A hub may also have a timer, for work due whether or not data arrives
+ * (see sh2_nextServiceDeadline()).  Each wait is shortened to the earliest
+ * timer of the hubs sharing the epoll set, and a hub whose timer has
+ * passed gets its expire function called.
+ *
+ * Hubs can be sharded across worker threads, each with its own epoll set
+ * and optional CPU affinity.  With no workers, the application drives the
+ * reactor from its own thread with linux_reactorRun().
+ */
+
+#ifndef LINUX_REACTOR_H
+#define LINUX_REACTOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define LINUX_REACTOR_MAX_HUBS    (16)
+#define LINUX_REACTOR_MAX_WORKERS (8)
+
+// Service one batch of a hub's data without blocking.
+// Returns > 0 if work was done (and more may be pending), 0 if the hub
+// had nothing to do, or a negative error code.
+typedef int (linux_ReactorService_t)(void *cookie);
+
+// Microseconds until a hub's timer is due, 0 if it already is, or
+// negative for no timer.
+typedef int64_t (linux_ReactorDelay_t)(void *cookie);
+
+typedef struct linux_ReactorConfig_s {
+    unsigned workers;       // Worker threads.  0: use linux_reactorRun() instead.
+    int cpu[LINUX_REACTOR_MAX_WORKERS];  // CPU for each worker, -1 for no affinity
+    unsigned budget;        // Service calls per hub per wakeup.  0 selects 4.
+} linux_ReactorConfig_t;
+
+typedef struct linux_ReactorHubStats_s {
+    uint32_t wakeups;       // Readiness events
+    uint32_t services;      // Service calls
+    uint32_t budgetHits;    // Wakeups that used the whole budget
+    uint32_t errors;        // Service and expire calls that returned an error
+    uint32_t timeouts;      // Expire calls
+
+    // Ready-to-first-service delay and ready-to-idle time, microseconds
+    uint32_t lastQueue_us;
+    uint32_t maxQueue_us;
+    uint64_t totalQueue_us;
+    uint32_t lastDrain_us;
+    uint32_t maxDrain_us;
+    uint64_t totalDrain_us;
+} linux_ReactorHubStats_t;
+
+typedef struct linux_Reactor_s linux_Reactor_t;
+
+typedef struct linux_ReactorHub_s {
+    bool inUse;
+    int fd;
+    linux_ReactorService_t *service;
+    void *cookie;
+    unsigned shard;
+
+    // Timer, optional
+    linux_ReactorDelay_t *delay;
+    linux_ReactorService_t *expire;
+    bool timerArmed;
+    uint64_t due_us;
+
+    // Current readiness cycle
+    bool busy;
+    bool serviced;
+    unsigned calls;
+    uint64_t ready_us;
+
+    linux_ReactorHubStats_t stats;
+} linux_ReactorHub_t;
+
+typedef struct linux_ReactorShard_s {
+    linux_Reactor_t *pReactor;
+    int epfd;
+    int stopFd;
+    int cpu;
+    unsigned hubs;
+    pthread_t thread;
+    bool running;
+    pthread_mutex_t statsLock;
+
+    // Hubs with work pending, in service order
+    linux_ReactorHub_t *busy[LINUX_REACTOR_MAX_HUBS];
+    unsigned busyCount;
+} linux_ReactorShard_t;
+
+struct linux_Reactor_s {
+    linux_ReactorConfig_t config;
+    linux_ReactorHub_t hub[LINUX_REACTOR_MAX_HUBS];
+    linux_ReactorShard_t shard[LINUX_REACTOR_MAX_WORKERS];
+    unsigned shards;
+};
+
+// Initialize a reactor.  Returns SH2_OK or a negative error code.
+int linux_reactorInit(linux_Reactor_t *pReactor, const linux_ReactorConfig_t *pConfig);
+
+// Release all resources.  Stops workers if running.
+void linux_reactorDeinit(linux_Reactor_t *pReactor);
+
+// Register a hub.  Hubs are assigned to the least loaded worker.
+// Must not be called while workers are running.
+// Returns the hub id (>= 0) or a negative error code.
+int linux_reactorAdd(linux_Reactor_t *pReactor, int fd,
+                     linux_ReactorService_t *service, void *cookie);
+
+// Unregister a hub.  Must not be called while workers are running.
+int linux_reactorRemove(linux_Reactor_t *pReactor, int hubId);
+
+// Replace a hub's descriptor, e.g. with sh2_getPollFd() on
+// SH2_SESSION_RESTORED after the HAL was reopened.  fd < 0 leaves the hub
+// with no descriptor, serviced by its timer only.  Safe to call while
+// workers are running, including from the hub's own callbacks.
+int linux_reactorSetFd(linux_Reactor_t *pReactor, int hubId, int fd);
+
+// Give a hub a timer, or remove it with delay 0.  Before each wait the
+// reactor asks delay() when the hub is next due, and calls expire() once
+// that time has passed.  Must not be called while workers are running.
+int linux_reactorSetTimer(linux_Reactor_t *pReactor, int hubId,
+                          linux_ReactorDelay_t *delay, linux_ReactorService_t *expire);
+
+// Single-threaded mode: wait up to timeout_ms for readiness, then service
+// ready hubs.  Returns the number of service calls made, or a negative
+// error code.
+int linux_reactorRun(linux_Reactor_t *pReactor, int timeout_ms);
+
+// Start worker threads.  Returns SH2_OK or a negative error code.
+int linux_reactorStart(linux_Reactor_t *pReactor);
+
+// Stop worker threads and wait for them to exit.
+void linux_reactorStop(linux_Reactor_t *pReactor);
+
+// Copy a hub's statistics.  Safe to call while workers are running.
+int linux_reactorGetStats(linux_Reactor_t *pReactor, int hubId, linux_ReactorHubStats_t *pStats);
+
+// Service function adapter for the sh2 API session (cookie unused).
+int linux_reactorServiceSh2(void *cookie);
+
+// Timer adapters for the sh2 API session (cookie unused): due at
+// sh2_nextServiceDeadline(), expired with sh2_service().  Without them the
+// stream watchdog, backpressure and session recovery only run when data
+// arrives.
+int64_t linux_reactorDelaySh2(void *cookie);
+int linux_reactorExpireSh2(void *cookie);
+
+#endif
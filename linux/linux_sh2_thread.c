@@ -0,0 +1,351 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Threaded mode for the sh2 driver.
+ */
+
+#include "linux_sh2_thread.h"
+#include "sh2_err.h"
+
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// ------------------------------------------------------------------------
+// Private definitions
+
+// Longest wait between sh2_service() calls for HALs without a poll fd
+#define POLL_SERVICE_MS (1)
+
+// Idle wait with a poll fd.  Bounded so HAL housekeeping done in read()
+// (e.g. paced UART transmission) keeps running.
+#define IDLE_WAIT_MS (10)
+
+// Longest an sh2 operation sleeps between reads while waiting for the
+// hub's answer, for the same reason.
+#define OP_WAIT_MS (1)
+
+typedef struct {
+    sh2_SensorId_t sensorId;
+    const sh2_SensorConfig_t *pConfig;
+} SetConfigArgs_t;
+
+typedef struct {
+    sh2_SensorId_t sensorId;
+    sh2_SensorConfig_t *pConfig;
+} GetConfigArgs_t;
+
+// ------------------------------------------------------------------------
+// Private functions
+
+// Wait for poll(): max_ms, or less if an sh2 timer is due sooner.
+static int waitMs(int max_ms)
+{
+    uint32_t delay_us;
+
+    if ((sh2_nextServiceDelay(&delay_us) == SH2_OK) && (delay_us < (uint32_t)max_ms * 1000)) {
+        return (int)((delay_us + 999) / 1000);
+    }
+
+    return max_ms;
+}
+
+// sh2 thread hook: only the service thread may talk to the hub.
+static bool isServiceThread(void *cookie)
+{
+    linux_Sh2Thread_t *pThread = (linux_Sh2Thread_t *)cookie;
+
+    return pthread_equal(pthread_self(), pThread->owner);
+}
+
+// sh2 thread hook: sleep on the hub while an operation waits for it.
+static void opWait(void *cookie, uint32_t timeout_us)
+{
+    (void)cookie;  // unused
+
+    struct pollfd pfd;
+    int ms = OP_WAIT_MS;
+
+    if (timeout_us < (uint32_t)ms * 1000) {
+        ms = (int)((timeout_us + 999) / 1000);
+    }
+
+    pfd.fd = sh2_getPollFd();
+    pfd.events = POLLIN;
+    if (pfd.fd >= 0) {
+        poll(&pfd, 1, ms);
+    }
+    else {
+        poll(0, 0, ms);
+    }
+}
+
+static void wake(linux_Sh2Thread_t *pThread)
+{
+    uint64_t one = 1;
+
+    if (write(pThread->wakeFd, &one, sizeof(one)) < 0) {
+        // Counter overflow only: the thread is awake anyway.
+    }
+}
+
+// Run queued calls.  Returns false once stop was requested.
+static bool runRequests(linux_Sh2Thread_t *pThread)
+{
+    pthread_mutex_lock(&pThread->lock);
+    for (;;) {
+        linux_Sh2Request_t *pReq = pThread->pHead;
+        if (pReq == 0) {
+            break;
+        }
+        pThread->pHead = pReq->pNext;
+        if (pThread->pHead == 0) {
+            pThread->pTail = 0;
+        }
+
+        // Data keeps flowing while the call runs: its op services SHTP.
+        pthread_mutex_unlock(&pThread->lock);
+        int result = pReq->call(pReq->arg);
+        pthread_mutex_lock(&pThread->lock);
+
+        pReq->result = result;
+        pReq->done = true;
+        pThread->calls++;
+        pthread_cond_broadcast(&pThread->cond);
+    }
+    bool stop = pThread->stop;
+    pthread_mutex_unlock(&pThread->lock);
+
+    return !stop;
+}
+
+static void *serviceMain(void *arg)
+{
+    linux_Sh2Thread_t *pThread = (linux_Sh2Thread_t *)arg;
+    const sh2_ThreadHooks_t hooks = {
+        .isOwner = isServiceThread,
+        .wait = opWait,
+        .cookie = pThread,
+    };
+
+    pThread->owner = pthread_self();
+    int rc = sh2_open(pThread->pHal, pThread->eventCallback, pThread->eventCookie);
+    if (rc == SH2_OK) {
+        sh2_setThreadHooks(&hooks);
+    }
+
+    pthread_mutex_lock(&pThread->lock);
+    pThread->openStatus = rc;
+    pThread->opened = true;
+    pthread_cond_broadcast(&pThread->cond);
+    pthread_mutex_unlock(&pThread->lock);
+
+    if (rc != SH2_OK) {
+        return 0;
+    }
+
+    bool hubPending = false;
+    while (runRequests(pThread)) {
+        struct pollfd pfd[2];
+        int hubFd = sh2_getPollFd();
+        uint64_t drain;
+
+        pfd[0].fd = pThread->wakeFd;
+        pfd[0].events = POLLIN;
+        pfd[1].fd = hubFd;
+        pfd[1].events = POLLIN;
+        pfd[1].revents = 0;
+
+        if (hubFd >= 0) {
+            // No new edge will come for data already waiting.
+            poll(pfd, 2, hubPending ? 0 : waitMs(IDLE_WAIT_MS));
+            if ((pfd[1].revents != 0) || hubPending) {
+                hubPending = (sh2_onReadable() == SH2_MAX_READS_PER_SERVICE);
+            }
+            else {
+                // sh2 timers, and HAL housekeeping
+                sh2_service();
+            }
+        }
+        else {
+            poll(pfd, 1, waitMs(POLL_SERVICE_MS));
+            sh2_service();
+        }
+
+        if (pfd[0].revents & POLLIN) {
+            if (read(pThread->wakeFd, &drain, sizeof(drain)) < 0) {
+                // Nothing to drain
+            }
+        }
+    }
+
+    sh2_close();
+
+    return 0;
+}
+
+static int setConfigCall(void *arg)
+{
+    SetConfigArgs_t *pArgs = (SetConfigArgs_t *)arg;
+
+    return sh2_setSensorConfig(pArgs->sensorId, pArgs->pConfig);
+}
+
+static int getConfigCall(void *arg)
+{
+    GetConfigArgs_t *pArgs = (GetConfigArgs_t *)arg;
+
+    return sh2_getSensorConfig(pArgs->sensorId, pArgs->pConfig);
+}
+
+static int getProdIdsCall(void *arg)
+{
+    return sh2_getProdIds((sh2_ProductIds_t *)arg);
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+int linux_sh2ThreadStart(linux_Sh2Thread_t *pThread, sh2_Hal_t *pHal,
+                         sh2_EventCallback_t *eventCallback, void *eventCookie)
+{
+    if ((pThread == 0) || (pHal == 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    memset(pThread, 0, sizeof(linux_Sh2Thread_t));
+    pThread->pHal = pHal;
+    pThread->eventCallback = eventCallback;
+    pThread->eventCookie = eventCookie;
+
+    pThread->wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (pThread->wakeFd < 0) {
+        return SH2_ERR;
+    }
+    pthread_mutex_init(&pThread->lock, 0);
+    pthread_cond_init(&pThread->cond, 0);
+
+    if (pthread_create(&pThread->thread, 0, serviceMain, pThread) != 0) {
+        close(pThread->wakeFd);
+        pthread_cond_destroy(&pThread->cond);
+        pthread_mutex_destroy(&pThread->lock);
+        return SH2_ERR;
+    }
+
+    // Wait for sh2_open() on the service thread.
+    pthread_mutex_lock(&pThread->lock);
+    while (!pThread->opened) {
+        pthread_cond_wait(&pThread->cond, &pThread->lock);
+    }
+    int rc = pThread->openStatus;
+    pthread_mutex_unlock(&pThread->lock);
+
+    if (rc != SH2_OK) {
+        pthread_join(pThread->thread, 0);
+        close(pThread->wakeFd);
+        pthread_cond_destroy(&pThread->cond);
+        pthread_mutex_destroy(&pThread->lock);
+    }
+
+    return rc;
+}
+
+void linux_sh2ThreadStop(linux_Sh2Thread_t *pThread)
+{
+    pthread_mutex_lock(&pThread->lock);
+    pThread->stop = true;
+    pthread_mutex_unlock(&pThread->lock);
+    wake(pThread);
+
+    pthread_join(pThread->thread, 0);
+
+    close(pThread->wakeFd);
+    pthread_cond_destroy(&pThread->cond);
+    pthread_mutex_destroy(&pThread->lock);
+}
+
+int linux_sh2Call(linux_Sh2Thread_t *pThread, linux_Sh2Call_t *call, void *arg)
+{
+    linux_Sh2Request_t req;
+    uint32_t depth = 1;
+
+    if (call == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    if (pthread_equal(pthread_self(), pThread->owner)) {
+        // Already on the service thread
+        return call(arg);
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.call = call;
+    req.arg = arg;
+
+    pthread_mutex_lock(&pThread->lock);
+    if (pThread->stop) {
+        pthread_mutex_unlock(&pThread->lock);
+        return SH2_ERR;
+    }
+    if (pThread->pTail != 0) {
+        pThread->pTail->pNext = &req;
+        for (linux_Sh2Request_t *p = pThread->pHead; p != &req; p = p->pNext) {
+            depth++;
+        }
+    }
+    else {
+        pThread->pHead = &req;
+    }
+    pThread->pTail = &req;
+    if (depth > pThread->maxQueueDepth) {
+        pThread->maxQueueDepth = depth;
+    }
+    pthread_mutex_unlock(&pThread->lock);
+
+    wake(pThread);
+
+    pthread_mutex_lock(&pThread->lock);
+    while (!req.done) {
+        pthread_cond_wait(&pThread->cond, &pThread->lock);
+    }
+    pthread_mutex_unlock(&pThread->lock);
+
+    return req.result;
+}
+
+int linux_sh2SetSensorConfig(linux_Sh2Thread_t *pThread,
+                             sh2_SensorId_t sensorId, const sh2_SensorConfig_t *pConfig)
+{
+    SetConfigArgs_t args = { .sensorId = sensorId, .pConfig = pConfig };
+
+    return linux_sh2Call(pThread, setConfigCall, &args);
+}
+
+int linux_sh2GetSensorConfig(linux_Sh2Thread_t *pThread,
+                             sh2_SensorId_t sensorId, sh2_SensorConfig_t *pConfig)
+{
+    GetConfigArgs_t args = { .sensorId = sensorId, .pConfig = pConfig };
+
+    return linux_sh2Call(pThread, getConfigCall, &args);
+}
+
+int linux_sh2GetProdIds(linux_Sh2Thread_t *pThread, sh2_ProductIds_t *pProdIds)
+{
+    return linux_sh2Call(pThread, getProdIdsCall, pProdIds);
+}
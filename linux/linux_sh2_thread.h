@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Threaded mode for the sh2 driver.
+ *
+ * A service thread opens the hub and is the only thread that touches
+ * sh2, SHTP and the HAL from then on.  Other threads run sh2 API calls
+ * through linux_sh2Call(): the call is queued for the service thread,
+ * which runs it between service passes, and the caller sleeps on a
+ * condition variable until it has completed.  Blocking calls therefore
+ * don't spin in the caller and can't race the data path.  sh2 calls that
+ * talk to the hub, made directly from any other thread, fail with SH2_ERR.
+ * While a call waits for the hub's answer, the service thread sleeps on
+ * the HAL's poll fd rather than polling read() continuously.
+ *
+ * Sensor and event callbacks run on the service thread.  Use
+ * sh2_setDeferredDispatch() to run them elsewhere.
+ */
+
+#ifndef LINUX_SH2_THREAD_H
+#define LINUX_SH2_THREAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "sh2.h"
+
+// A function run on the service thread, e.g. one that calls
+// sh2_setSensorConfig().  Its return value is passed back to the caller.
+typedef int (linux_Sh2Call_t)(void *arg);
+
+typedef struct linux_Sh2Request_s {
+    linux_Sh2Call_t *call;
+    void *arg;
+    int result;
+    bool done;
+    struct linux_Sh2Request_s *pNext;
+} linux_Sh2Request_t;
+
+typedef struct linux_Sh2Thread_s {
+    sh2_Hal_t *pHal;
+    sh2_EventCallback_t *eventCallback;
+    void *eventCookie;
+
+    pthread_t thread;
+    pthread_t owner;            // The service thread, as it sees itself
+    pthread_mutex_t lock;
+    pthread_cond_t cond;        // Signalled when a request completes or open finishes
+    int wakeFd;                 // eventfd waking the service thread
+
+    // Guarded by lock
+    linux_Sh2Request_t *pHead;
+    linux_Sh2Request_t *pTail;
+    bool opened;
+    int openStatus;
+    bool stop;
+
+    // Stats, guarded by lock
+    uint32_t calls;
+    uint32_t maxQueueDepth;
+} linux_Sh2Thread_t;
+
+// Start the service thread and open the hub on it with sh2_open().
+// Returns the result of sh2_open().  The HAL's read() should not block
+// (waitMs 0) if it provides a poll fd, so requests are picked up promptly.
+int linux_sh2ThreadStart(linux_Sh2Thread_t *pThread, sh2_Hal_t *pHal,
+                         sh2_EventCallback_t *eventCallback, void *eventCookie);
+
+// Close the hub and stop the service thread.  Queued calls still run.
+void linux_sh2ThreadStop(linux_Sh2Thread_t *pThread);
+
+// Run call(arg) on the service thread and wait for it to finish.
+// Returns its result.  Called from the service thread itself (e.g. from
+// a callback), it runs the call directly.
+int linux_sh2Call(linux_Sh2Thread_t *pThread, linux_Sh2Call_t *call, void *arg);
+
+// Convenience forms of linux_sh2Call() for common calls.
+int linux_sh2SetSensorConfig(linux_Sh2Thread_t *pThread,
+                             sh2_SensorId_t sensorId, const sh2_SensorConfig_t *pConfig);
+int linux_sh2GetSensorConfig(linux_Sh2Thread_t *pThread,
+                             sh2_SensorId_t sensorId, sh2_SensorConfig_t *pConfig);
+int linux_sh2GetProdIds(linux_Sh2Thread_t *pThread, sh2_ProductIds_t *pProdIds);
+
+#endif
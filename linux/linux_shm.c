@@ -0,0 +1,295 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Shared-memory fan-out of decoded sensor reports.
+ */
+
+#include "linux_shm.h"
+#include "sh2_err.h"
+
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ------------------------------------------------------------------------
+// Private types
+
+#define RING_MAGIC   (0x53483252)  // "SH2R"
+#define RING_VERSION (1)
+
+typedef struct linux_ShmSlot_s {
+    // Sequence number of the sample in this slot, 0 while it is written.
+    _Atomic uint64_t seq;
+    sh2_SensorValue_t value;
+} linux_ShmSlot_t;
+
+struct linux_ShmRing_s {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slots;
+    uint32_t slotSize;
+    uint32_t sensorId;
+    _Atomic uint32_t closed;
+    _Atomic uint64_t writeSeq;  // Sequence number of the newest sample
+    linux_ShmSlot_t slot[];
+};
+
+// ------------------------------------------------------------------------
+// Private functions
+
+static int ringName(char *name, const char *base, uint8_t sensorId)
+{
+    int n = snprintf(name, LINUX_SHM_NAME_MAX, "%s.%02x", base, sensorId);
+
+    return ((n < 0) || (n >= LINUX_SHM_NAME_MAX)) ? SH2_ERR_BAD_PARAM : SH2_OK;
+}
+
+static linux_ShmRing_t *createRing(linux_ShmPublisher_t *pPub, uint8_t sensorId)
+{
+    char name[LINUX_SHM_NAME_MAX];
+    linux_ShmRing_t *pRing;
+    int fd;
+
+    if (ringName(name, pPub->base, sensorId) != SH2_OK) {
+        return 0;
+    }
+
+    // Start fresh: subscribers of a previous publisher keep their old
+    // mapping, which was marked closed.
+    shm_unlink(name);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return 0;
+    }
+    if (ftruncate(fd, pPub->ringSize) < 0) {
+        close(fd);
+        shm_unlink(name);
+        return 0;
+    }
+
+    pRing = mmap(0, pPub->ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pRing == MAP_FAILED) {
+        shm_unlink(name);
+        return 0;
+    }
+
+    // ftruncate() zero-filled the ring, so every slot starts empty.
+    pRing->slots = pPub->slots;
+    pRing->slotSize = sizeof(linux_ShmSlot_t);
+    pRing->sensorId = sensorId;
+    pRing->version = RING_VERSION;
+    atomic_thread_fence(memory_order_release);
+    pRing->magic = RING_MAGIC;
+
+    return pRing;
+}
+
+// Copy the sample with sequence number seq out of the ring.
+// Returns false if the slot no longer (or not yet) holds it.
+static bool readSlot(const linux_ShmRing_t *pRing, uint64_t seq, sh2_SensorValue_t *pValue)
+{
+    linux_ShmSlot_t *pSlot = (linux_ShmSlot_t *)&pRing->slot[(seq - 1) % pRing->slots];
+
+    if (atomic_load_explicit(&pSlot->seq, memory_order_acquire) != seq) {
+        return false;
+    }
+    memcpy(pValue, &pSlot->value, sizeof(sh2_SensorValue_t));
+    atomic_thread_fence(memory_order_acquire);
+
+    // Check the writer didn't start reusing the slot during the copy.
+    return atomic_load_explicit(&pSlot->seq, memory_order_relaxed) == seq;
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+int linux_shmPublisherInit(linux_ShmPublisher_t *pPub, const char *baseName, uint32_t slots)
+{
+    if ((pPub == 0) || (baseName == 0) || (baseName[0] != '/') || (slots == 0) ||
+        (strlen(baseName) + 4 > LINUX_SHM_NAME_MAX)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    memset(pPub, 0, sizeof(linux_ShmPublisher_t));
+    strcpy(pPub->base, baseName);
+    pPub->slots = slots;
+    pPub->ringSize = sizeof(linux_ShmRing_t) + (size_t)slots * sizeof(linux_ShmSlot_t);
+
+    return SH2_OK;
+}
+
+void linux_shmPublisherDeinit(linux_ShmPublisher_t *pPub)
+{
+    char name[LINUX_SHM_NAME_MAX];
+
+    for (unsigned id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+        linux_ShmRing_t *pRing = pPub->ring[id];
+
+        if (pRing != 0) {
+            atomic_store_explicit(&pRing->closed, 1, memory_order_release);
+            munmap(pRing, pPub->ringSize);
+            if (ringName(name, pPub->base, id) == SH2_OK) {
+                shm_unlink(name);
+            }
+            pPub->ring[id] = 0;
+        }
+    }
+}
+
+int linux_shmPublish(linux_ShmPublisher_t *pPub, const sh2_SensorValue_t *pValue)
+{
+    linux_ShmRing_t *pRing;
+
+    if (pValue->sensorId > SH2_MAX_SENSOR_ID) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    pRing = pPub->ring[pValue->sensorId];
+    if (pRing == 0) {
+        pRing = createRing(pPub, pValue->sensorId);
+        if (pRing == 0) {
+            pPub->createErrors++;
+            return SH2_ERR_IO;
+        }
+        pPub->ring[pValue->sensorId] = pRing;
+    }
+
+    // Only this process writes, so writeSeq needs no read-modify-write.
+    uint64_t seq = atomic_load_explicit(&pRing->writeSeq, memory_order_relaxed) + 1;
+    linux_ShmSlot_t *pSlot = &pRing->slot[(seq - 1) % pRing->slots];
+
+    // Seqlock: mark the slot busy, fill it, then publish the new number.
+    atomic_store_explicit(&pSlot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&pSlot->value, pValue, sizeof(sh2_SensorValue_t));
+    atomic_store_explicit(&pSlot->seq, seq, memory_order_release);
+    atomic_store_explicit(&pRing->writeSeq, seq, memory_order_release);
+
+    return SH2_OK;
+}
+
+void linux_shmSensorCallback(void *cookie, sh2_SensorEvent_t *pEvent)
+{
+    linux_ShmPublisher_t *pPub = (linux_ShmPublisher_t *)cookie;
+    sh2_SensorValue_t value;
+
+    if (sh2_decodeSensorEvent(&value, pEvent) != SH2_OK) {
+        pPub->decodeErrors++;
+        return;
+    }
+
+    linux_shmPublish(pPub, &value);
+}
+
+int linux_shmSubscribe(linux_ShmSubscriber_t *pSub, const char *baseName, uint8_t sensorId)
+{
+    char name[LINUX_SHM_NAME_MAX];
+    struct stat st;
+    linux_ShmRing_t *pRing;
+    int fd;
+
+    if ((pSub == 0) || (baseName == 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+    memset(pSub, 0, sizeof(linux_ShmSubscriber_t));
+
+    if (ringName(name, baseName, sensorId) != SH2_OK) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return SH2_ERR_IO;
+    }
+    if ((fstat(fd, &st) < 0) || ((size_t)st.st_size < sizeof(linux_ShmRing_t))) {
+        close(fd);
+        return SH2_ERR_IO;
+    }
+
+    pRing = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pRing == MAP_FAILED) {
+        return SH2_ERR_IO;
+    }
+
+    if ((pRing->magic != RING_MAGIC) || (pRing->version != RING_VERSION) ||
+        (pRing->slotSize != sizeof(linux_ShmSlot_t)) ||
+        (sizeof(linux_ShmRing_t) + (size_t)pRing->slots * pRing->slotSize > (size_t)st.st_size)) {
+        munmap(pRing, st.st_size);
+        return SH2_ERR;
+    }
+
+    pSub->pRing = pRing;
+    pSub->ringSize = st.st_size;
+    pSub->nextSeq = atomic_load_explicit(&pRing->writeSeq, memory_order_acquire) + 1;
+
+    return SH2_OK;
+}
+
+void linux_shmUnsubscribe(linux_ShmSubscriber_t *pSub)
+{
+    if (pSub->pRing != 0) {
+        munmap(pSub->pRing, pSub->ringSize);
+        pSub->pRing = 0;
+    }
+}
+
+int linux_shmRead(linux_ShmSubscriber_t *pSub, sh2_SensorValue_t *pValue, uint64_t *pSeq)
+{
+    linux_ShmRing_t *pRing = pSub->pRing;
+
+    if (pRing == 0) {
+        return SH2_ERR;
+    }
+
+    for (;;) {
+        // Check closed first, so samples published before closing are read.
+        bool closed = atomic_load_explicit(&pRing->closed, memory_order_acquire) != 0;
+        uint64_t writeSeq = atomic_load_explicit(&pRing->writeSeq, memory_order_acquire);
+
+        if (pSub->nextSeq > writeSeq) {
+            return closed ? SH2_ERR_IO : 0;
+        }
+
+        // Too far behind: the oldest unread samples are already gone.
+        if (writeSeq - pSub->nextSeq >= pRing->slots) {
+            uint64_t oldest = writeSeq - pRing->slots + 1;
+            pSub->overruns += oldest - pSub->nextSeq;
+            pSub->nextSeq = oldest;
+        }
+
+        if (readSlot(pRing, pSub->nextSeq, pValue)) {
+            if (pSeq != 0) {
+                *pSeq = pSub->nextSeq;
+            }
+            pSub->nextSeq++;
+            pSub->received++;
+            return 1;
+        }
+
+        // Overwritten while we read it: lost, try the next one.
+        pSub->overruns++;
+        pSub->nextSeq++;
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Shared-memory fan-out of decoded sensor reports.
+ *
+ * The publisher keeps one POSIX shared-memory ring per sensor, named
+ * "<base>.<sensorId>" (e.g. "/sh2.28" for sensor 0x28).  Rings are
+ * created the first time a sensor publishes.  Any number of processes can
+ * subscribe to a ring; they map it read-only and never block the
+ * publisher.
+ *
+ * Every sample carries a sequence number.  A subscriber that falls more
+ * than a ring's length behind, or whose read races with the slot being
+ * overwritten, skips ahead and counts the lost samples as overruns.
+ *
+ * Link with -lrt on older C libraries.
+ */
+
+#ifndef LINUX_SHM_H
+#define LINUX_SHM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sh2.h"
+#include "sh2_SensorValue.h"
+
+#define LINUX_SHM_NAME_MAX (64)
+
+// Shared ring layout, private to linux_shm.c
+typedef struct linux_ShmRing_s linux_ShmRing_t;
+
+typedef struct linux_ShmPublisher_s {
+    char base[LINUX_SHM_NAME_MAX];
+    uint32_t slots;
+    size_t ringSize;
+    linux_ShmRing_t *ring[SH2_MAX_SENSOR_ID + 1];
+
+    // Stats
+    uint32_t decodeErrors;  // Events sh2_decodeSensorEvent() rejected
+    uint32_t createErrors;  // Rings that couldn't be created
+} linux_ShmPublisher_t;
+
+typedef struct linux_ShmSubscriber_s {
+    linux_ShmRing_t *pRing;
+    size_t ringSize;
+    uint64_t nextSeq;       // Sequence number of the next sample to read
+
+    // Stats
+    uint64_t received;
+    uint64_t overruns;      // Samples overwritten before they were read
+} linux_ShmSubscriber_t;
+
+// Initialize a publisher.  baseName must start with '/'.  slots is the
+// number of samples each sensor's ring holds.
+int linux_shmPublisherInit(linux_ShmPublisher_t *pPub, const char *baseName, uint32_t slots);
+
+// Mark every ring closed to subscribers and remove it.
+void linux_shmPublisherDeinit(linux_ShmPublisher_t *pPub);
+
+// Publish one decoded sample into its sensor's ring.
+int linux_shmPublish(linux_ShmPublisher_t *pPub, const sh2_SensorValue_t *pValue);
+
+// sh2 sensor callback that decodes and publishes each event.  Register
+// with sh2_setSensorCallback(linux_shmSensorCallback, pPub).
+void linux_shmSensorCallback(void *cookie, sh2_SensorEvent_t *pEvent);
+
+// Attach to the ring for a sensor.  Reading starts with the next sample
+// published.  Fails if the publisher hasn't created the ring yet.
+int linux_shmSubscribe(linux_ShmSubscriber_t *pSub, const char *baseName, uint8_t sensorId);
+
+void linux_shmUnsubscribe(linux_ShmSubscriber_t *pSub);
+
+// Read the next sample without blocking.  Returns 1 if a sample was read,
+// 0 if none is available yet, or SH2_ERR_IO once the publisher has closed
+// the ring and every sample in it was read.  If pSeq is not NULL it
+// receives the sample's sequence number.
+int linux_shmRead(linux_ShmSubscriber_t *pSub, sh2_SensorValue_t *pValue, uint64_t *pSeq);
+
+#endif
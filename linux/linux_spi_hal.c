@@ -0,0 +1,343 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Reference SH2 HAL for Linux spidev.
+ */
+
+#include "linux_spi_hal.h"
+#include "linux_gpio.h"
+#include "sh2_err.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/spi/spidev.h>
+
+// ------------------------------------------------------------------------
+// Private definitions
+
+#define SHTP_HDR_LEN (4)
+
+#define DEFAULT_SPEED_HZ (3000000)
+
+// Reset timing: NRST asserted for RESET_HOLD_US, then released.
+#define RESET_HOLD_US (10000)
+
+#define CONSUMER "sh2-spi"
+
+// ------------------------------------------------------------------------
+// Private functions
+
+static uint64_t nowUs(void)
+{
+    struct timespec ts;
+
+    // Same clock as the GPIO edge timestamps
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000;
+}
+
+static uint32_t spiHalGetTimeUs(sh2_Hal_t *self)
+{
+    (void)self; // unused
+
+    return (uint32_t)nowUs();
+}
+
+static void releaseLines(linux_SpiHal_t *pSpiHal)
+{
+    linux_gpioRelease(pSpiHal->intnFd);
+    linux_gpioRelease(pSpiHal->resetFd);
+    linux_gpioRelease(pSpiHal->wakeFd);
+    pSpiHal->intnFd = -1;
+    pSpiHal->resetFd = -1;
+    pSpiHal->wakeFd = -1;
+}
+
+static int requestLines(linux_SpiHal_t *pSpiHal)
+{
+    const linux_SpiHalConfig_t *pConfig = &pSpiHal->config;
+
+    pSpiHal->intnFd = linux_gpioRequestIntn(pConfig->gpioChip, pConfig->intnLine, CONSUMER);
+    if (pSpiHal->intnFd < 0) {
+        return SH2_ERR_IO;
+    }
+
+    // Hold the hub in reset until the lines are all configured.
+    if (pConfig->resetLine >= 0) {
+        pSpiHal->resetFd = linux_gpioRequestOutput(pConfig->gpioChip, pConfig->resetLine,
+                                                   true, CONSUMER);
+        if (pSpiHal->resetFd < 0) {
+            return SH2_ERR_IO;
+        }
+    }
+
+    // PS0/WAKE must be high (deasserted) at boot to select SPI mode.
+    if (pConfig->wakeLine >= 0) {
+        pSpiHal->wakeFd = linux_gpioRequestOutput(pConfig->gpioChip, pConfig->wakeLine,
+                                                  false, CONSUMER);
+        if (pSpiHal->wakeFd < 0) {
+            return SH2_ERR_IO;
+        }
+    }
+
+    return SH2_OK;
+}
+
+static int configureSpi(linux_SpiHal_t *pSpiHal)
+{
+    uint8_t mode = SPI_MODE_3;  // CPOL = 1, CPHA = 1
+    uint8_t bits = 8;
+    uint32_t speed = pSpiHal->config.speedHz ? pSpiHal->config.speedHz : DEFAULT_SPEED_HZ;
+
+    if ((ioctl(pSpiHal->spiFd, SPI_IOC_WR_MODE, &mode) < 0) ||
+        (ioctl(pSpiHal->spiFd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) ||
+        (ioctl(pSpiHal->spiFd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0)) {
+        return SH2_ERR_IO;
+    }
+
+    return SH2_OK;
+}
+
+static int spiHalOpen(sh2_Hal_t *self)
+{
+    linux_SpiHal_t *pSpiHal = (linux_SpiHal_t *)self;
+    int rc;
+
+    pSpiHal->txLen = 0;
+    pSpiHal->edgeValid = false;
+
+    pSpiHal->spiFd = open(pSpiHal->config.spiDevice, O_RDWR | O_CLOEXEC);
+    if (pSpiHal->spiFd < 0) {
+        return SH2_ERR_IO;
+    }
+
+    rc = configureSpi(pSpiHal);
+    if ((rc == SH2_OK) && (pSpiHal->config.gpioChip != 0)) {
+        rc = requestLines(pSpiHal);
+    }
+    if (rc != SH2_OK) {
+        releaseLines(pSpiHal);
+        close(pSpiHal->spiFd);
+        pSpiHal->spiFd = -1;
+        return rc;
+    }
+
+    // Complete the reset cycle.  The hub asserts H_INTN once it has booted.
+    if (pSpiHal->resetFd >= 0) {
+        usleep(RESET_HOLD_US);
+        linux_gpioSet(pSpiHal->resetFd, false);
+    }
+
+    return SH2_OK;
+}
+
+static void spiHalClose(sh2_Hal_t *self)
+{
+    linux_SpiHal_t *pSpiHal = (linux_SpiHal_t *)self;
+
+    // Leave the hub in reset
+    if (pSpiHal->resetFd >= 0) {
+        linux_gpioSet(pSpiHal->resetFd, true);
+    }
+
+    releaseLines(pSpiHal);
+
+    if (pSpiHal->spiFd >= 0) {
+        close(pSpiHal->spiFd);
+        pSpiHal->spiFd = -1;
+    }
+}
+
+// Perform one full-duplex SHTP transfer.
+// Returns number of valid bytes received into pBuffer, 0 if the hub had
+// nothing to send, or a negative error code.
+static int spiTransfer(linux_SpiHal_t *pSpiHal, uint8_t *pBuffer, unsigned len)
+{
+    struct spi_ioc_transfer xfer;
+    unsigned rxLen;
+    unsigned xferLen;
+
+    // Header phase.  cs_change on the last transfer of a message keeps CS
+    // asserted so the body can be sized from the header.
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.tx_buf = (uintptr_t)pSpiHal->txBuf;
+    xfer.rx_buf = (uintptr_t)pBuffer;
+    xfer.len = SHTP_HDR_LEN;
+    xfer.cs_change = 1;
+    if (ioctl(pSpiHal->spiFd, SPI_IOC_MESSAGE(1), &xfer) < 0) {
+        pSpiHal->ioErrors++;
+        return SH2_ERR_IO;
+    }
+
+    rxLen = (pBuffer[0] | (pBuffer[1] << 8)) & ~0x8000u;
+    if ((pBuffer[0] == 0xFF) && (pBuffer[1] == 0xFF)) {
+        // Bus idle level, nothing valid was read.
+        rxLen = 0;
+    }
+
+    // Body phase: long enough for what the hub offers and what we send.
+    // Never clock out more than txBuf holds, even for a larger caller
+    // buffer (see sh2_setMemoryConfig()).
+    xferLen = (rxLen > pSpiHal->txLen) ? rxLen : pSpiHal->txLen;
+    if (xferLen > len) {
+        // The hub sends the remainder as a continuation.
+        xferLen = len;
+    }
+    if (xferLen > sizeof(pSpiHal->txBuf)) {
+        xferLen = sizeof(pSpiHal->txBuf);
+    }
+    if (xferLen < SHTP_HDR_LEN) {
+        xferLen = SHTP_HDR_LEN;
+    }
+
+    // Even with no body this message is needed to release CS.
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.tx_buf = (uintptr_t)(pSpiHal->txBuf + SHTP_HDR_LEN);
+    xfer.rx_buf = (uintptr_t)(pBuffer + SHTP_HDR_LEN);
+    xfer.len = xferLen - SHTP_HDR_LEN;
+    xfer.cs_change = 0;
+    if (ioctl(pSpiHal->spiFd, SPI_IOC_MESSAGE(1), &xfer) < 0) {
+        pSpiHal->ioErrors++;
+        return SH2_ERR_IO;
+    }
+
+    pSpiHal->transfers++;
+
+    // Write (if any) is complete.
+    if (pSpiHal->txLen != 0) {
+        memset(pSpiHal->txBuf, 0, pSpiHal->txLen);
+        pSpiHal->txLen = 0;
+        if (pSpiHal->wakeFd >= 0) {
+            linux_gpioSet(pSpiHal->wakeFd, false);
+        }
+        if (rxLen == 0) {
+            pSpiHal->txOnlyTransfers++;
+        }
+    }
+
+    if (rxLen == 0) {
+        return 0;
+    }
+
+    return (rxLen < xferLen) ? rxLen : xferLen;
+}
+
+static int spiHalReadTs(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint64_t *t_us)
+{
+    linux_SpiHal_t *pSpiHal = (linux_SpiHal_t *)self;
+    int rc;
+
+    if (len < SHTP_HDR_LEN) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    // Without H_INTN, every read() polls the bus.
+    if ((pSpiHal->intnFd >= 0) &&
+        !linux_gpioWaitAsserted(pSpiHal->intnFd, pSpiHal->config.waitMs,
+                                &pSpiHal->edge_ns, &pSpiHal->edgeValid)) {
+        return 0;
+    }
+
+    rc = spiTransfer(pSpiHal, pBuffer, len);
+    if (rc > 0) {
+        if (pSpiHal->edgeValid) {
+            // Kernel timestamp of the H_INTN edge
+            *t_us = pSpiHal->edge_ns / 1000;
+        }
+        else {
+            // H_INTN stayed asserted from the previous transfer
+            *t_us = nowUs();
+        }
+    }
+    pSpiHal->edgeValid = false;
+
+    return rc;
+}
+
+static int spiHalRead(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us)
+{
+    uint64_t t64_us = 0;
+    int rc = spiHalReadTs(self, pBuffer, len, &t64_us);
+
+    *t_us = (uint32_t)t64_us;
+
+    return rc;
+}
+
+static int spiHalWrite(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len)
+{
+    linux_SpiHal_t *pSpiHal = (linux_SpiHal_t *)self;
+
+    if (len > SH2_HAL_MAX_TRANSFER_OUT) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    if (pSpiHal->txLen != 0) {
+        // Previous write not clocked out yet.
+        return 0;
+    }
+
+    memcpy(pSpiHal->txBuf, pBuffer, len);
+    pSpiHal->txLen = len;
+
+    // Ask the hub to assert H_INTN so the write can proceed.
+    if (pSpiHal->wakeFd >= 0) {
+        linux_gpioSet(pSpiHal->wakeFd, true);
+    }
+
+    return len;
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+sh2_Hal_t *linux_spiHalInit(linux_SpiHal_t *pSpiHal, const linux_SpiHalConfig_t *pConfig)
+{
+    if ((pSpiHal == 0) || (pConfig == 0) || (pConfig->spiDevice == 0)) {
+        return 0;
+    }
+
+    memset(pSpiHal, 0, sizeof(linux_SpiHal_t));
+    pSpiHal->config = *pConfig;
+    pSpiHal->spiFd = -1;
+    pSpiHal->intnFd = -1;
+    pSpiHal->resetFd = -1;
+    pSpiHal->wakeFd = -1;
+
+    pSpiHal->hal.open = spiHalOpen;
+    pSpiHal->hal.close = spiHalClose;
+    pSpiHal->hal.read = spiHalRead;
+    pSpiHal->hal.write = spiHalWrite;
+    pSpiHal->hal.getTimeUs = spiHalGetTimeUs;
+    pSpiHal->hal.getPollFd = linux_spiHalGetFd;
+    pSpiHal->hal.readTs = spiHalReadTs;
+
+    return &pSpiHal->hal;
+}
+
+int linux_spiHalGetFd(sh2_Hal_t *pHal)
+{
+    linux_SpiHal_t *pSpiHal = (linux_SpiHal_t *)pHal;
+
+    return pSpiHal->intnFd;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Reference SH2 HAL for Linux hosts connected to the sensor hub via spidev.
+ *
+ * Transfers are full duplex: a pending write is clocked out while the
+ * next transfer from the hub is clocked in.  Each transfer reads the
+ * 4-byte SHTP header first and then reads only as many body bytes as the
+ * header (or the pending write) calls for.  H_INTN is monitored through
+ * the GPIO character device so the kernel edge timestamp can be used as
+ * the transfer timestamp.
+ *
+ * If gpioChip is NULL, no GPIO lines are used: every read() performs a
+ * header read and a zero length header means "no data".  This allows the
+ * HAL to be exercised against a loopback stand-in (MISO tied to MOSI),
+ * where each written transfer is read back as a received one.
+ */
+
+#ifndef LINUX_SPI_HAL_H
+#define LINUX_SPI_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sh2_hal.h"
+
+typedef struct linux_SpiHalConfig_s {
+    const char *spiDevice;  // spidev node, e.g. "/dev/spidev0.0"
+    uint32_t speedHz;       // SPI clock.  0 selects 3 MHz.
+    const char *gpioChip;   // GPIO chip for the lines below, e.g. "/dev/gpiochip0"
+    unsigned intnLine;      // H_INTN line offset
+    int resetLine;          // NRST line offset, -1 if not connected
+    int wakeLine;           // PS0/WAKE line offset, -1 if not connected
+    int waitMs;             // Max time read() blocks for H_INTN. (0: never block,
+                            // required when driven by sh2_onReadable())
+} linux_SpiHalConfig_t;
+
+typedef struct linux_SpiHal_s {
+    sh2_Hal_t hal;          // Must be first: pointer is passed to sh2_open()
+    linux_SpiHalConfig_t config;
+
+    int spiFd;
+    int intnFd;
+    int resetFd;
+    int wakeFd;
+
+    // Timestamp of the H_INTN edge not yet matched with a transfer
+    bool edgeValid;
+    uint64_t edge_ns;
+
+    // Pending write, clocked out with the next transfer
+    unsigned txLen;
+    uint8_t txBuf[SH2_HAL_MAX_TRANSFER_IN];
+
+    // Stats
+    uint32_t transfers;
+    uint32_t txOnlyTransfers;
+    uint32_t ioErrors;
+} linux_SpiHal_t;
+
+// Initialize a SPI HAL instance.  No devices are opened until sh2_open()
+// calls the HAL's open function.  Returns the sh2_Hal_t to pass to sh2_open().
+sh2_Hal_t *linux_spiHalInit(linux_SpiHal_t *pSpiHal, const linux_SpiHalConfig_t *pConfig);
+
+// Get the fd that becomes readable when H_INTN is asserted, for use with
+// poll() or epoll.  Returns -1 if the HAL is not open or has no H_INTN line.
+int linux_spiHalGetFd(sh2_Hal_t *pHal);
+
+#endif
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Linux termios byte stream for the SHTP-over-UART framing layer.
+ */
+
+#include "linux_uart.h"
+#include "linux_gpio.h"
+#include "sh2_err.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// ------------------------------------------------------------------------
+// Private definitions
+
+// Reset timing: NRST asserted for RESET_HOLD_US, then released.
+#define RESET_HOLD_US (10000)
+
+static const struct {
+    uint32_t baud;
+    speed_t speed;
+} speeds[] = {
+    {   9600, B9600 },
+    {  19200, B19200 },
+    {  38400, B38400 },
+    {  57600, B57600 },
+    { 115200, B115200 },
+    { 230400, B230400 },
+    { 460800, B460800 },
+    { 921600, B921600 },
+    {1000000, B1000000 },
+    {1500000, B1500000 },
+    {2000000, B2000000 },
+    {3000000, B3000000 },
+};
+
+// ------------------------------------------------------------------------
+// Private functions
+
+static uint32_t uartGetTimeUs(shtp_ByteStream_t *self)
+{
+    (void)self; // unused
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000);
+}
+
+static int configureTty(linux_Uart_t *pUart)
+{
+    struct termios tio;
+
+    if (tcgetattr(pUart->fd, &tio) < 0) {
+        return SH2_ERR_IO;
+    }
+
+    // Raw 8N1, no flow control
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+
+    if (pUart->config.baud != 0) {
+        unsigned n;
+        for (n = 0; n < sizeof(speeds)/sizeof(speeds[0]); n++) {
+            if (speeds[n].baud == pUart->config.baud) {
+                break;
+            }
+        }
+        if (n >= sizeof(speeds)/sizeof(speeds[0])) {
+            return SH2_ERR_BAD_PARAM;
+        }
+        cfsetispeed(&tio, speeds[n].speed);
+        cfsetospeed(&tio, speeds[n].speed);
+    }
+
+    if (tcsetattr(pUart->fd, TCSANOW, &tio) < 0) {
+        return SH2_ERR_IO;
+    }
+
+    // Discard anything left over from a previous session
+    tcflush(pUart->fd, TCIOFLUSH);
+
+    return SH2_OK;
+}
+
+static int uartOpen(shtp_ByteStream_t *self)
+{
+    linux_Uart_t *pUart = (linux_Uart_t *)self;
+    int rc;
+
+    pUart->fd = open(pUart->config.ttyDevice, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (pUart->fd < 0) {
+        return SH2_ERR_IO;
+    }
+
+    rc = configureTty(pUart);
+    if ((rc == SH2_OK) && (pUart->config.gpioChip != 0) && (pUart->config.resetLine >= 0)) {
+        pUart->resetFd = linux_gpioRequestOutput(pUart->config.gpioChip, pUart->config.resetLine,
+                                                 true, "sh2-uart");
+        if (pUart->resetFd < 0) {
+            rc = SH2_ERR_IO;
+        }
+    }
+    if (rc != SH2_OK) {
+        close(pUart->fd);
+        pUart->fd = -1;
+        return rc;
+    }
+
+    if (pUart->resetFd >= 0) {
+        usleep(RESET_HOLD_US);
+        linux_gpioSet(pUart->resetFd, false);
+    }
+
+    return SH2_OK;
+}
+
+static void uartClose(shtp_ByteStream_t *self)
+{
+    linux_Uart_t *pUart = (linux_Uart_t *)self;
+
+    if (pUart->resetFd >= 0) {
+        linux_gpioSet(pUart->resetFd, true);
+        linux_gpioRelease(pUart->resetFd);
+        pUart->resetFd = -1;
+    }
+
+    if (pUart->fd >= 0) {
+        close(pUart->fd);
+        pUart->fd = -1;
+    }
+}
+
+static int uartRead(shtp_ByteStream_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us)
+{
+    linux_Uart_t *pUart = (linux_Uart_t *)self;
+
+    ssize_t got = read(pUart->fd, pBuffer, len);
+    if (got < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+            return 0;
+        }
+        return SH2_ERR_IO;
+    }
+
+    *t_us = uartGetTimeUs(self);
+
+    return (int)got;
+}
+
+static int uartWrite(shtp_ByteStream_t *self, const uint8_t *pBuffer, unsigned len)
+{
+    linux_Uart_t *pUart = (linux_Uart_t *)self;
+
+    ssize_t put = write(pUart->fd, pBuffer, len);
+    if (put < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+            return 0;
+        }
+        return SH2_ERR_IO;
+    }
+
+    return (int)put;
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+shtp_ByteStream_t *linux_uartInit(linux_Uart_t *pUart, const linux_UartConfig_t *pConfig)
+{
+    if ((pUart == 0) || (pConfig == 0) || (pConfig->ttyDevice == 0)) {
+        return 0;
+    }
+
+    memset(pUart, 0, sizeof(linux_Uart_t));
+    pUart->config = *pConfig;
+    pUart->fd = -1;
+    pUart->resetFd = -1;
+
+    pUart->stream.open = uartOpen;
+    pUart->stream.close = uartClose;
+    pUart->stream.read = uartRead;
+    pUart->stream.write = uartWrite;
+    pUart->stream.getTimeUs = uartGetTimeUs;
+    pUart->stream.getPollFd = linux_uartGetFd;
+
+    return &pUart->stream;
+}
+
+int linux_uartGetFd(shtp_ByteStream_t *pStream)
+{
+    linux_Uart_t *pUart = (linux_Uart_t *)pStream;
+
+    return pUart->fd;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Linux termios byte stream for the SHTP-over-UART framing layer.
+ *
+ * Opens a tty in raw, non-blocking mode.  Any tty works, including the
+ * slave side of a pty pair, which lets the framing layer be exercised
+ * against a simulated hub on the master side.
+ */
+
+#ifndef LINUX_UART_H
+#define LINUX_UART_H
+
+#include <stdint.h>
+
+#include "shtp_uart.h"
+
+typedef struct linux_UartConfig_s {
+    const char *ttyDevice;  // e.g. "/dev/ttyS1" or a pty slave path
+    uint32_t baud;          // e.g. 3000000.  0 leaves the speed unchanged.
+    const char *gpioChip;   // GPIO chip for NRST, NULL if not used
+    int resetLine;          // NRST line offset, -1 if not connected
+} linux_UartConfig_t;
+
+typedef struct linux_Uart_s {
+    shtp_ByteStream_t stream;   // Must be first
+    linux_UartConfig_t config;
+    int fd;
+    int resetFd;
+} linux_Uart_t;
+
+// Initialize a termios byte stream.  The tty is opened when the framing
+// layer's HAL is opened.  Returns the stream to pass to shtp_uartInit().
+shtp_ByteStream_t *linux_uartInit(linux_Uart_t *pUart, const linux_UartConfig_t *pConfig);
+
+// Get the tty fd, for use with poll() or epoll.  -1 if not open.
+int linux_uartGetFd(shtp_ByteStream_t *pStream);
+
+#endif
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * sh2_muxd: share one sensor hub among local processes.
+ *
+ * Usage:
+ *   sh2_muxd SOCKET spi  SPIDEV GPIOCHIP INTN RESET WAKE
+ *   sh2_muxd SOCKET i2c  I2CDEV ADDR GPIOCHIP INTN RESET
+ *   sh2_muxd SOCKET uart TTY BAUD
+ *
+ * Line offsets of -1 mean the line isn't connected.  Clients use the
+ * functions in linux_mux.h to connect to SOCKET.
+ */
+
+#include "linux_mux.h"
+#include "linux_spi_hal.h"
+#include "linux_i2c_hal.h"
+#include "linux_uart.h"
+#include "shtp_uart.h"
+#include "sh2.h"
+#include "sh2_err.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ------------------------------------------------------------------------
+// Private data
+
+static linux_SpiHal_t spiHal;
+static linux_I2cHal_t i2cHal;
+static linux_Uart_t uart;
+static shtp_Uart_t uartHal;
+static linux_MuxServer_t server;
+
+static volatile sig_atomic_t stop = 0;
+
+// ------------------------------------------------------------------------
+// Private functions
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: sh2_muxd SOCKET spi  SPIDEV GPIOCHIP INTN RESET WAKE\n"
+            "       sh2_muxd SOCKET i2c  I2CDEV ADDR GPIOCHIP INTN RESET\n"
+            "       sh2_muxd SOCKET uart TTY BAUD\n");
+}
+
+static void onSignal(int sig)
+{
+    (void)sig; // unused
+    stop = 1;
+}
+
+static void eventCallback(void *cookie, sh2_AsyncEvent_t *pEvent)
+{
+    (void)cookie; // unused
+
+    if (pEvent->eventId == SH2_RESET) {
+        linux_muxServerOnReset(&server);
+    }
+}
+
+static sh2_Hal_t *halFromArgs(int argc, char *argv[])
+{
+    if ((argc == 8) && (strcmp(argv[2], "spi") == 0)) {
+        linux_SpiHalConfig_t config = {
+            .spiDevice = argv[3],
+            .gpioChip = argv[4],
+            .intnLine = (unsigned)atoi(argv[5]),
+            .resetLine = atoi(argv[6]),
+            .wakeLine = atoi(argv[7]),
+            .waitMs = 0,
+        };
+        return linux_spiHalInit(&spiHal, &config);
+    }
+    if ((argc == 8) && (strcmp(argv[2], "i2c") == 0)) {
+        linux_I2cHalConfig_t config = {
+            .i2cDevice = argv[3],
+            .address = (uint16_t)strtoul(argv[4], 0, 0),
+            .gpioChip = argv[5],
+            .intnLine = (unsigned)atoi(argv[6]),
+            .resetLine = atoi(argv[7]),
+            .waitMs = 0,
+        };
+        return linux_i2cHalInit(&i2cHal, &config);
+    }
+    if ((argc == 5) && (strcmp(argv[2], "uart") == 0)) {
+        linux_UartConfig_t config = {
+            .ttyDevice = argv[3],
+            .baud = (uint32_t)strtoul(argv[4], 0, 0),
+            .gpioChip = 0,
+            .resetLine = -1,
+        };
+        shtp_UartConfig_t uartConfig = {
+            .txByteGap_us = 0,
+            .useBsq = false,
+        };
+        return shtp_uartInit(&uartHal, linux_uartInit(&uart, &config), &uartConfig);
+    }
+
+    return 0;
+}
+
+// ------------------------------------------------------------------------
+// Main
+
+int main(int argc, char *argv[])
+{
+    sh2_Hal_t *pHal = 0;
+    int rc;
+
+    if (argc >= 3) {
+        pHal = halFromArgs(argc, argv);
+    }
+    if (pHal == 0) {
+        usage();
+        return 2;
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    rc = sh2_open(pHal, eventCallback, 0);
+    if (rc != SH2_OK) {
+        fprintf(stderr, "sh2_muxd: sh2_open failed (%d)\n", rc);
+        return 1;
+    }
+
+    rc = linux_muxServerInit(&server, argv[1]);
+    if (rc != SH2_OK) {
+        fprintf(stderr, "sh2_muxd: can't listen on %s (%d)\n", argv[1], rc);
+        sh2_close();
+        return 1;
+    }
+
+    while (!stop) {
+        if (linux_muxServerService(&server, 100) != SH2_OK) {
+            fprintf(stderr, "sh2_muxd: hub I/O error\n");
+            break;
+        }
+    }
+
+    linux_muxServerDeinit(&server);
+    sh2_close();
+
+    return 0;
+}
@@ -39,6 +39,7 @@
 #include "sh2_err.h"
 #include "shtp.h"
 #include "sh2_util.h"
+#include "sh2_SensorValue.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -81,6 +82,98 @@
 
 #define ADVERT_TIMEOUT_US (200000)
 
+// Optional features, each 1 to build it in or 0 to leave it out.  All are
+// in by default and out under SH2_FOOTPRINT_SMALL (see shtp.h), and each
+// can also be set on its own.  The APIs of a feature left out return
+// SH2_ERR, or do nothing when asked to disable it.
+#if defined(SH2_FOOTPRINT_SMALL)
+#define SH2_FEATURE_DEFAULT (0)
+#else
+#define SH2_FEATURE_DEFAULT (1)
+#endif
+
+// Per-sensor rates for sh2_nextServiceDeadline().  Backpressure and the
+// stream watchdog need them.
+#ifndef SH2_WITH_PLAN
+#define SH2_WITH_PLAN SH2_FEATURE_DEFAULT
+#endif
+
+// Report age statistics, sh2_getReportLatency()
+#ifndef SH2_WITH_LATENCY
+#define SH2_WITH_LATENCY SH2_FEATURE_DEFAULT
+#endif
+
+// Consumer backpressure loop, sh2_setBackpressure()
+#ifndef SH2_WITH_BACKPRESSURE
+#define SH2_WITH_BACKPRESSURE SH2_FEATURE_DEFAULT
+#endif
+
+// Stream liveness watchdog, sh2_setWatchdog()
+#ifndef SH2_WITH_WATCHDOG
+#define SH2_WITH_WATCHDOG SH2_FEATURE_DEFAULT
+#endif
+
+// Session recovery and its sensor configuration cache, sh2_setRecovery()
+#ifndef SH2_WITH_RECOVERY
+#define SH2_WITH_RECOVERY SH2_FEATURE_DEFAULT
+#endif
+
+#if (SH2_WITH_BACKPRESSURE || SH2_WITH_WATCHDOG) && !SH2_WITH_PLAN
+#error "SH2_WITH_BACKPRESSURE and SH2_WITH_WATCHDOG need SH2_WITH_PLAN"
+#endif
+
+// Wheel encoder samples held by sh2_queueWheelEncoder() until they are
+// sent, and how many of them are packed into one SHTP payload.  0 removes
+// the queue.
+#ifndef SH2_WHEEL_QUEUE_LEN
+#define SH2_WHEEL_QUEUE_LEN (SH2_FEATURE_DEFAULT ? 16 : 0)
+#endif
+#ifndef SH2_WHEEL_REPORTS_PER_PAYLOAD
+#define SH2_WHEEL_REPORTS_PER_PAYLOAD (4)
+#endif
+
+// Bounds on the period suggested by sh2_nextServiceDeadline()
+#ifndef SH2_PLAN_MIN_PERIOD_US
+#define SH2_PLAN_MIN_PERIOD_US (250)
+#endif
+#ifndef SH2_PLAN_MAX_PERIOD_US
+#define SH2_PLAN_MAX_PERIOD_US (100000)
+#endif
+
+// Transfer size assumed for one service call until larger ones are seen
+#ifndef SH2_PLAN_MIN_TRANSFER
+#define SH2_PLAN_MIN_TRANSFER (256)
+#endif
+
+// Callbacks held for sh2_dispatchDeferred().  0 removes deferred dispatch.
+#ifndef SH2_DEFER_QUEUE_LEN
+#define SH2_DEFER_QUEUE_LEN (SH2_FEATURE_DEFAULT ? 16 : 0)
+#endif
+
+// Orders queue writes between the service and dispatch threads.
+#ifndef SH2_MEMORY_BARRIER
+#if defined(__GNUC__)
+#define SH2_MEMORY_BARRIER() __sync_synchronize()
+#else
+#define SH2_MEMORY_BARRIER()
+#endif
+#endif
+
+// Time the stream watchdog waits for the hub to answer a recovery action
+#ifndef SH2_WATCHDOG_OP_TIMEOUT_US
+#define SH2_WATCHDOG_OP_TIMEOUT_US (200000)
+#endif
+
+// Time a backpressure step waits for the hub to answer a sensor config read
+#ifndef SH2_BACKPRESSURE_OP_TIMEOUT_US
+#define SH2_BACKPRESSURE_OP_TIMEOUT_US (200000)
+#endif
+
+// Session recovery states
+#define RECOVERY_IDLE       (0)  // Session open, or no recovery in progress
+#define RECOVERY_BACKOFF    (1)  // HAL closed, waiting to reopen it
+#define RECOVERY_RESET_WAIT (2)  // HAL reopened, waiting for the hub's reset
+
 // Command and Subcommand values
 #define SH2_CMD_ERRORS                 1
 #define SH2_CMD_COUNTS                 2
@@ -273,6 +366,25 @@ typedef union {
 // Max length of an FRS record, words.
 #define MAX_FRS_WORDS (72)
 
+#if SH2_DEFER_QUEUE_LEN > 0
+typedef struct sh2_Deferred_s {
+    bool isSensor;
+    union {
+        sh2_SensorEvent_t sensor;
+        sh2_AsyncEvent_t async;
+    } u;
+} sh2_Deferred_t;
+#endif
+
+#if SH2_WHEEL_QUEUE_LEN > 0
+typedef struct sh2_WheelSample_s {
+    uint8_t wheelIndex;
+    uint8_t dataType;
+    int16_t wheelData;
+    uint32_t timestamp;
+} sh2_WheelSample_t;
+#endif
+
 struct sh2_s {
     // Pointer to the SHTP HAL
     sh2_Hal_t *pHal;
@@ -290,6 +402,7 @@ struct sh2_s {
     uint8_t lastCmdId;
     uint8_t cmdSeq;
     uint8_t nextCmdSeq;
+    uint32_t cmdAnswered;  // Bit per command id seen in a response
     
     // Event callback and it's cookie
     sh2_EventCallback_t *eventCallback;
@@ -299,10 +412,96 @@ struct sh2_s {
     sh2_SensorCallback_t *sensorCallback;
     void * sensorCookie;
 
+    // GIRV fast path
+    sh2_GirvCallback_t *girvCallback;
+    void *girvCookie;
+    sh2_GyroIntegratedRV_t girv;
+    sh2_GirvStats_t girvStats;
+    uint64_t girvTotal_us;
+
+    // Timestamp base of the input payload being streamed
+    int32_t streamReferenceDelta;
+    bool lowLatencyInput;
+
     // Storage space for reading sensor metadata
     uint32_t frsData[MAX_FRS_WORDS];
     uint16_t frsDataLen;
 
+#if SH2_WHEEL_QUEUE_LEN > 0
+    // Wheel encoder samples waiting to be sent
+    sh2_WheelSample_t wheelQueue[SH2_WHEEL_QUEUE_LEN];
+    uint16_t wheelHead;
+    uint16_t wheelCount;
+    sh2_WheelQueueStats_t wheelStats;
+#endif
+
+    // Service planning: what services returned, and active sensor rates
+    uint32_t lastService_us;
+    bool lastServiceRead;
+    uint16_t maxTransfer;
+#if SH2_WITH_PLAN
+    uint32_t planInterval_us[SH2_MAX_SENSOR_ID + 1];
+    uint32_t planBatch_us[SH2_MAX_SENSOR_ID + 1];
+#endif
+
+#if SH2_WITH_LATENCY
+    // Age of each sensor's reports when they reach the host
+    sh2_ReportLatency_t latency[SH2_MAX_SENSOR_ID + 1];
+#endif
+
+#if SH2_WITH_BACKPRESSURE
+    // Backpressure feedback loop
+    bool bpEnabled;
+    bool bpBusy;
+    sh2_BackpressureConfig_t bpConfig;
+    uint8_t bpLevel;
+    volatile uint8_t bpAppBacklog;
+    uint32_t bpLastStep_us;
+    bool bpRetry;                               // Last step abandoned
+    uint32_t bpBase_us[SH2_MAX_SENSOR_ID + 1];  // Configured intervals, level 0
+#endif
+
+#if SH2_WITH_WATCHDOG
+    // Stream liveness watchdog
+    bool wdEnabled;
+    bool wdBusy;
+    sh2_WatchdogConfig_t wdConfig;
+    uint32_t wdLast_us[SH2_MAX_SENSOR_ID + 1];   // Latest report, or when enabled
+    uint32_t wdRetry_us[SH2_MAX_SENSOR_ID + 1];  // Latest recovery attempt
+    bool wdOnChange[SH2_MAX_SENSOR_ID + 1];      // Reports only on change
+    bool wdStalled[SH2_MAX_SENSOR_ID + 1];
+#endif
+
+#if SH2_WITH_RECOVERY
+    // Session recovery after HAL failure
+    bool recEnabled;
+    bool recBusy;
+    bool recResetSent;
+    uint8_t recState;
+    sh2_RecoveryConfig_t recConfig;
+    sh2_RecoveryStats_t recStats;
+    uint32_t recAttempts;    // Reopens tried in this outage
+    uint32_t recStart_us;    // When the session was lost
+    uint32_t recNext_us;     // Next reopen, or end of the reset wait
+    uint32_t recBackoff_us;
+    sh2_SensorConfig_t sensorConfig[SH2_MAX_SENSOR_ID + 1];  // Set since the last reset
+#endif
+
+#if SH2_DEFER_QUEUE_LEN > 0
+    // Deferred callbacks.  The service side only writes deferIn, the
+    // dispatch side only writes deferOut.
+    bool deferEnabled;
+    sh2_DeferNotify_t *deferNotify;
+    void *deferCookie;
+    sh2_Deferred_t deferQueue[SH2_DEFER_QUEUE_LEN];
+    volatile uint32_t deferIn;
+    volatile uint32_t deferOut;
+    sh2_DeferStats_t deferStats;
+#endif
+
+    // Service thread hooks, see sh2_setThreadHooks()
+    sh2_ThreadHooks_t threadHooks;
+
     // Stats
     uint32_t execBadPayload;
     uint32_t emptyPayloads;
@@ -431,6 +630,10 @@ sh2_t _sh2;
 // SH2 Async Event Message
 static sh2_AsyncEvent_t sh2AsyncEvent;
 
+// SHTP buffers for the next open, from sh2_setMemoryConfig()
+static shtp_Buffers_t shtpBuffers;
+static uint32_t arenaBytes;
+
 // Lengths of reports by report id.
 static const sh2_ReportLen_t sh2ReportLens[] = {
     // Sensor reports
@@ -541,6 +744,84 @@ static void opOnReset(sh2_t *pSh2)
     }
 }
 
+// ------------------------------------------------------------------------
+// Callback delivery, immediate or deferred
+
+#if SH2_DEFER_QUEUE_LEN > 0
+// Get a free queue entry, or 0 if the consumer has fallen behind.
+static sh2_Deferred_t *deferAlloc(sh2_t *pSh2)
+{
+    uint32_t used = pSh2->deferIn - pSh2->deferOut;
+
+    if (used >= SH2_DEFER_QUEUE_LEN) {
+        return 0;
+    }
+    if (used + 1 > pSh2->deferStats.highWater) {
+        pSh2->deferStats.highWater = used + 1;
+    }
+
+    return &pSh2->deferQueue[pSh2->deferIn % SH2_DEFER_QUEUE_LEN];
+}
+
+static void deferCommit(sh2_t *pSh2)
+{
+    // Entry contents must be visible before the index moves.
+    SH2_MEMORY_BARRIER();
+    pSh2->deferIn++;
+    pSh2->deferStats.queued++;
+
+    if (pSh2->deferNotify != 0) {
+        pSh2->deferNotify(pSh2->deferCookie);
+    }
+}
+#endif
+
+static void deliverSensorEvent(sh2_t *pSh2, sh2_SensorEvent_t *pEvent)
+{
+    if (pSh2->sensorCallback == 0) {
+        return;
+    }
+
+#if SH2_DEFER_QUEUE_LEN > 0
+    if (pSh2->deferEnabled) {
+        sh2_Deferred_t *pEntry = deferAlloc(pSh2);
+        if (pEntry == 0) {
+            pSh2->deferStats.droppedSensor++;
+            return;
+        }
+        pEntry->isSensor = true;
+        pEntry->u.sensor = *pEvent;
+        deferCommit(pSh2);
+        return;
+    }
+#endif
+
+    pSh2->sensorCallback(pSh2->sensorCookie, pEvent);
+}
+
+static void deliverAsyncEvent(sh2_t *pSh2, sh2_AsyncEvent_t *pEvent)
+{
+    if (pSh2->eventCallback == 0) {
+        return;
+    }
+
+#if SH2_DEFER_QUEUE_LEN > 0
+    if (pSh2->deferEnabled) {
+        sh2_Deferred_t *pEntry = deferAlloc(pSh2);
+        if (pEntry == 0) {
+            pSh2->deferStats.droppedAsync++;
+            return;
+        }
+        pEntry->isSensor = false;
+        pEntry->u.async = *pEvent;
+        deferCommit(pSh2);
+        return;
+    }
+#endif
+
+    pSh2->eventCallback(pSh2->eventCookie, pEvent);
+}
+
 static uint8_t getReportLen(uint8_t reportId)
 {
     for (unsigned n = 0; n < ARRAY_LEN(sh2ReportLens); n++) {
@@ -552,7 +833,39 @@ static uint8_t getReportLen(uint8_t reportId)
     return 0;
 }
 
-static void sensorhubControlHdlr(void *cookie, uint8_t *payload, uint16_t len, uint32_t timestamp)
+// Record a sensor's rates for the service planner.
+static void planSensor(sh2_t *pSh2, uint8_t sensorId, uint32_t interval_us, uint32_t batch_us)
+{
+#if SH2_WITH_PLAN
+    if (sensorId <= SH2_MAX_SENSOR_ID) {
+#if SH2_WITH_WATCHDOG
+        if ((interval_us != 0) && (pSh2->planInterval_us[sensorId] == 0)) {
+            // Newly enabled: the watchdog counts from now.
+            pSh2->wdLast_us[sensorId] = pSh2->pHal->getTimeUs(pSh2->pHal);
+        }
+#endif
+        pSh2->planInterval_us[sensorId] = interval_us;
+        pSh2->planBatch_us[sensorId] = batch_us;
+    }
+#else
+    (void)pSh2;         // unused
+    (void)sensorId;     // unused
+    (void)interval_us;  // unused
+    (void)batch_us;     // unused
+#endif
+}
+
+// Record the outcome of a service call for the service planner.
+static void planService(sh2_t *pSh2, int len, bool more)
+{
+    pSh2->lastService_us = pSh2->pHal->getTimeUs(pSh2->pHal);
+    pSh2->lastServiceRead = more;
+    if ((len > 0) && (len > pSh2->maxTransfer)) {
+        pSh2->maxTransfer = len;
+    }
+}
+
+static void sensorhubControlHdlr(void *cookie, uint8_t *payload, uint16_t len, uint64_t timestamp)
 {
     (void)timestamp;  // unused.
     
@@ -583,6 +896,9 @@ static void sensorhubControlHdlr(void *cookie, uint8_t *payload, uint16_t len, u
             // Check for unsolicited initialize response
             if (reportId == SENSORHUB_COMMAND_RESP) {
                 pResp = (CommandResp_t *)(payload+cursor);
+                if ((pResp->command & 0x7F) < 32) {
+                    pSh2->cmdAnswered |= (1u << (pResp->command & 0x7F));
+                }
                 if ((pResp->command == (SH2_CMD_INITIALIZE | SH2_INIT_UNSOLICITED)) &&
                     (pResp->r[1] == SH2_INIT_SYSTEM)) {
                     // This is an unsolicited INIT message.
@@ -591,9 +907,15 @@ static void sensorhubControlHdlr(void *cookie, uint8_t *payload, uint16_t len, u
 
             } // Check for Get Feature Response
             else if (reportId == SENSORHUB_GET_FEATURE_RESP) {
+                GetFeatureResp_t * pGetFeatureResp;
+                pGetFeatureResp = (GetFeatureResp_t *)(payload + cursor);
+
+                // The hub reports the rates it actually uses.
+                planSensor(pSh2, pGetFeatureResp->featureReportId,
+                           pGetFeatureResp->reportInterval_uS,
+                           pGetFeatureResp->batchInterval_uS);
+
                 if (pSh2->eventCallback) {
-                    GetFeatureResp_t * pGetFeatureResp;
-                    pGetFeatureResp = (GetFeatureResp_t *)(payload + cursor);
 
                     sh2AsyncEvent.eventId = SH2_GET_FEATURE_RESP;
                     sh2AsyncEvent.sh2SensorConfigResp.sensorId = pGetFeatureResp->featureReportId;
@@ -614,7 +936,7 @@ static void sensorhubControlHdlr(void *cookie, uint8_t *payload, uint16_t len, u
                     sh2AsyncEvent.sh2SensorConfigResp.sensorConfig.sensorSpecific =
                         pGetFeatureResp->sensorSpecific;
 
-                    pSh2->eventCallback(pSh2->eventCookie, &sh2AsyncEvent);
+                    deliverAsyncEvent(pSh2, &sh2AsyncEvent);
                 }
             }
 
@@ -626,11 +948,32 @@ static void sensorhubControlHdlr(void *cookie, uint8_t *payload, uint16_t len, u
 }
 
 
+// Defined with the wheel encoder support below
+static void wheelFlush(sh2_t *pSh2);
+
+// True once enough HAL reads and writes have failed to start recovery.
+static bool halFailed(sh2_t *pSh2)
+{
+#if SH2_WITH_RECOVERY
+    return pSh2->recEnabled &&
+        (shtp_halFailures(pSh2->pShtp) >= pSh2->recConfig.failureLimit);
+#else
+    (void)pSh2;  // unused
+
+    return false;
+#endif
+}
+
 static int opProcess(sh2_t *pSh2, const sh2_Op_t *pOp)
 {
     int status = SH2_OK;
     uint32_t start_us = 0;
 
+    if ((pSh2->threadHooks.isOwner != 0) &&
+        !pSh2->threadHooks.isOwner(pSh2->threadHooks.cookie)) {
+        return SH2_ERR;  // Not the service thread
+    }
+
     start_us = pSh2->pHal->getTimeUs(pSh2->pHal);
     
     status = opStart(pSh2, pOp);
@@ -651,10 +994,29 @@ static int opProcess(sh2_t *pSh2, const sh2_Op_t *pOp)
         }
             
         // Service SHTP to poll the device.
-        shtp_service(pSh2->pShtp);
+        int len = shtp_service(pSh2->pShtp);
+        if ((len < 0) && halFailed(pSh2)) {
+            // No answer will come.  Leave the session to recovery.
+            opCompleted(pSh2, SH2_ERR_IO);
+            break;
+        }
+
+        // Keep wheel data flowing during long operations.
+        wheelFlush(pSh2);
 
         // Update the time
         now_us = pSh2->pHal->getTimeUs(pSh2->pHal);
+
+        if ((len == 0) && (pSh2->pOp != 0) && (pSh2->threadHooks.wait != 0)) {
+            // Nothing from the hub yet: sleep until it has something.
+            uint32_t wait_us = UINT32_MAX;
+            if (pOp->timeout_us != 0) {
+                uint32_t elapsed_us = now_us - start_us;
+                wait_us = (elapsed_us < pOp->timeout_us) ? (pOp->timeout_us - elapsed_us) : 0;
+            }
+            pSh2->threadHooks.wait(pSh2->threadHooks.cookie, wait_us);
+            now_us = pSh2->pHal->getTimeUs(pSh2->pHal);
+        }
     }
 
     if (pSh2->pOp != 0) {
@@ -667,30 +1029,72 @@ static int opProcess(sh2_t *pSh2, const sh2_Op_t *pOp)
 }
 
 // Produce 64-bit microsecond timestamp for a sensor event
-static uint64_t touSTimestamp(uint32_t hostInt, int32_t referenceDelta, uint16_t delay)
+static uint64_t touSTimestamp(uint64_t hostInt, int32_t referenceDelta, uint16_t delay)
 {
-    static uint32_t lastHostInt = 0;
-    static uint32_t rollovers = 0;
-    uint64_t timestamp;
+    // hostInt is already extended to 64 bits by SHTP
+    return hostInt + (int64_t)(referenceDelta + delay) * 100;
+}
 
-    // Count times hostInt timestamps rolled over to produce upper bits
-    if (hostInt < lastHostInt) {
-        rollovers++;
+// Track how long reports were held (batched) before the host interrupt.
+static void recordLatency(sh2_t *pSh2, uint8_t sensorId, int64_t delay_uS)
+{
+#if SH2_WITH_LATENCY
+    if (sensorId > SH2_MAX_SENSOR_ID) {
+        return;
     }
-    lastHostInt = hostInt;
-    
-    timestamp = ((uint64_t)rollovers << 32);
-    timestamp += hostInt + (referenceDelta + delay) * 100;
 
-    return timestamp;
+    // delay_uS is the sample time relative to the interrupt.
+    uint32_t age_us = (delay_uS < 0) ? (uint32_t)-delay_uS : 0;
+    sh2_ReportLatency_t *pLatency = &pSh2->latency[sensorId];
+
+    pLatency->reports++;
+    pLatency->last_us = age_us;
+    if (age_us > pLatency->max_us) {
+        pLatency->max_us = age_us;
+    }
+#else
+    (void)pSh2;      // unused
+    (void)sensorId;  // unused
+    (void)delay_uS;  // unused
+#endif
+}
+
+// Note a report's arrival for the stream watchdog.
+static void watchdogFeed(sh2_t *pSh2, uint8_t sensorId, uint64_t timestamp)
+{
+#if SH2_WITH_WATCHDOG
+    if (sensorId > SH2_MAX_SENSOR_ID) {
+        return;
+    }
+
+    uint32_t silent_us = (uint32_t)timestamp - pSh2->wdLast_us[sensorId];
+    pSh2->wdLast_us[sensorId] = (uint32_t)timestamp;
+
+    if (pSh2->wdStalled[sensorId]) {
+        pSh2->wdStalled[sensorId] = false;
+
+        sh2AsyncEvent.eventId = SH2_STREAM_RESUMED;
+        sh2AsyncEvent.streamStall.sensorId = sensorId;
+        sh2AsyncEvent.streamStall.silent_us = silent_us;
+        sh2AsyncEvent.streamStall.expected_us = pSh2->planInterval_us[sensorId];
+        deliverAsyncEvent(pSh2, &sh2AsyncEvent);
+    }
+#else
+    (void)pSh2;       // unused
+    (void)sensorId;   // unused
+    (void)timestamp;  // unused
+#endif
 }
 
-static void sensorhubInputHdlr(sh2_t *pSh2, uint8_t *payload, uint16_t len, uint32_t timestamp)
+// Timestamp base references carry over between calls through
+// *pReferenceDelta, so a streamed payload can be handled in pieces.
+static void sensorhubInputHdlr(sh2_t *pSh2, uint8_t *payload, uint16_t len, uint64_t timestamp,
+                               int32_t *pReferenceDelta)
 {
     sh2_SensorEvent_t event;
     uint16_t cursor = 0;
 
-    int32_t referenceDelta = 0;
+    int32_t referenceDelta = *pReferenceDelta;
 
     while (cursor < len) {
         // Get next report id
@@ -709,11 +1113,13 @@ static void sensorhubInputHdlr(sh2_t *pSh2, uint8_t *payload, uint16_t len, uint
                 
                 // store base timestamp reference
                 referenceDelta = -rpt->timebase;
+                *pReferenceDelta = referenceDelta;
             }
             else if (reportId == SENSORHUB_TIMESTAMP_REBASE) {
                 const TimestampRebase_t *rpt = (const TimestampRebase_t *)(payload+cursor);
 
                 referenceDelta += rpt->timebase;
+                *pReferenceDelta = referenceDelta;
             }
             else if (reportId == SENSORHUB_FLUSH_COMPLETED) {
                 // Route this as if it arrived on command channel.
@@ -728,9 +1134,9 @@ static void sensorhubInputHdlr(sh2_t *pSh2, uint8_t *payload, uint16_t len, uint
                 event.reportId = reportId;
                 memcpy(event.report, pReport, reportLen);
                 event.len = reportLen;
-                if (pSh2->sensorCallback != 0) {
-                    pSh2->sensorCallback(pSh2->sensorCookie, &event);
-                }
+                recordLatency(pSh2, reportId, event.delay_uS);
+                watchdogFeed(pSh2, reportId, timestamp);
+                deliverSensorEvent(pSh2, &event);
             }
             
             // Move to next report in the payload
@@ -739,21 +1145,51 @@ static void sensorhubInputHdlr(sh2_t *pSh2, uint8_t *payload, uint16_t len, uint
     }
 }
 
-static void sensorhubInputNormalHdlr(void *cookie, uint8_t *payload, uint16_t len, uint32_t timestamp)
+static void sensorhubInputNormalHdlr(void *cookie, uint8_t *payload, uint16_t len, uint64_t timestamp)
 {
     sh2_t *pSh2 = (sh2_t *)cookie;
+    int32_t referenceDelta = 0;
 
-    sensorhubInputHdlr(pSh2, payload, len, timestamp);
+    sensorhubInputHdlr(pSh2, payload, len, timestamp, &referenceDelta);
 }
 
-static void sensorhubInputWakeHdlr(void *cookie, uint8_t *payload, uint16_t len, uint32_t timestamp)
+static void sensorhubInputWakeHdlr(void *cookie, uint8_t *payload, uint16_t len, uint64_t timestamp)
 {
     sh2_t *pSh2 = (sh2_t *)cookie;
+    int32_t referenceDelta = 0;
     
-    sensorhubInputHdlr(pSh2, payload, len, timestamp);
+    sensorhubInputHdlr(pSh2, payload, len, timestamp, &referenceDelta);
+}
+
+// Pieces of a streamed input payload, normal or wake.
+static void sensorhubInputStreamHdlr(void *cookie, uint8_t *data, uint16_t len,
+                                     uint64_t timestamp, bool first)
+{
+    sh2_t *pSh2 = (sh2_t *)cookie;
+
+    if (first) {
+        pSh2->streamReferenceDelta = 0;
+    }
+
+    sensorhubInputHdlr(pSh2, data, len, timestamp, &pSh2->streamReferenceDelta);
 }
 
-static void sensorhubInputGyroRvHdlr(void *cookie, uint8_t *payload, uint16_t len, uint32_t timestamp)
+static uint8_t inputReportLen(void *cookie, const uint8_t *pReport)
+{
+    (void)cookie;  // unused
+
+    return getReportLen(pReport[0]);
+}
+
+static void setInputStreaming(sh2_t *pSh2, shtp_StreamMode_t mode)
+{
+    shtp_streamChan(pSh2->pShtp, CHAN_SENSORHUB_INPUT, mode,
+                    inputReportLen, sensorhubInputStreamHdlr, pSh2);
+    shtp_streamChan(pSh2->pShtp, CHAN_SENSORHUB_INPUT_WAKE, mode,
+                    inputReportLen, sensorhubInputStreamHdlr, pSh2);
+}
+
+static void sensorhubInputGyroRvHdlr(void *cookie, uint8_t *payload, uint16_t len, uint64_t timestamp)
 {
     sh2_t *pSh2 = (sh2_t *)cookie;
     sh2_SensorEvent_t event;
@@ -762,21 +1198,67 @@ static void sensorhubInputGyroRvHdlr(void *cookie, uint8_t *payload, uint16_t le
     uint8_t reportId = SH2_GYRO_INTEGRATED_RV;
     uint8_t reportLen = getReportLen(reportId);
 
+    if (len != 0) {
+        watchdogFeed(pSh2, reportId, timestamp);
+    }
+
     while (cursor < len) {
         event.timestamp_uS = timestamp;
         event.reportId = reportId;
         memcpy(event.report, payload+cursor, reportLen);
         event.len = reportLen;
 
-        if (pSh2->sensorCallback != 0) {
-            pSh2->sensorCallback(pSh2->sensorCookie, &event);
+        deliverSensorEvent(pSh2, &event);
+
+        cursor += reportLen;
+    }
+}
+
+static uint8_t girvReportLen(void *cookie, const uint8_t *pReport)
+{
+    (void)cookie;   // unused
+    (void)pReport;  // GIRV reports have no report id
+
+    return getReportLen(SH2_GYRO_INTEGRATED_RV);
+}
+
+// GIRV fast path: reports are decoded in the transfer buffer.
+static void sensorhubInputGirvFastHdlr(void *cookie, uint8_t *data, uint16_t len,
+                                       uint64_t timestamp, bool first)
+{
+    (void)first;  // unused
+
+    sh2_t *pSh2 = (sh2_t *)cookie;
+    sh2_GirvStats_t *pStats = &pSh2->girvStats;
+    uint8_t reportLen = girvReportLen(pSh2, data);
+    uint16_t cursor = 0;
+
+    if (len >= reportLen) {
+        watchdogFeed(pSh2, SH2_GYRO_INTEGRATED_RV, timestamp);
+    }
+
+    while (cursor + reportLen <= len) {
+        sh2_decodeGyroIntegratedRV(&pSh2->girv, data + cursor);
+
+        // Interrupt to callback, on the 32-bit HAL clock
+        uint32_t latency_us = pSh2->pHal->getTimeUs(pSh2->pHal) - (uint32_t)timestamp;
+        pStats->reports++;
+        pStats->last_us = latency_us;
+        if ((pStats->reports == 1) || (latency_us < pStats->min_us)) {
+            pStats->min_us = latency_us;
         }
+        if (latency_us > pStats->max_us) {
+            pStats->max_us = latency_us;
+        }
+        pSh2->girvTotal_us += latency_us;
+
+        pSh2->girvCallback(pSh2->girvCookie, &pSh2->girv, timestamp);
 
         cursor += reportLen;
     }
 }
 
-static void executableDeviceHdlr(void *cookie, uint8_t *payload, uint16_t len, uint32_t timestamp)
+static void executableDeviceHdlr(void *cookie, uint8_t *payload, uint16_t len, uint64_t timestamp)
 {
     (void)timestamp;  // unused
     
@@ -792,16 +1274,32 @@ static void executableDeviceHdlr(void *cookie, uint8_t *payload, uint16_t len, u
         case EXECUTABLE_DEVICE_RESP_RESET_COMPLETE:
             // reset process is now done.
             pSh2->resetComplete = true;
+
+            // All sensors are off after a reset.
+#if SH2_WITH_PLAN
+            memset(pSh2->planInterval_us, 0, sizeof(pSh2->planInterval_us));
+            memset(pSh2->planBatch_us, 0, sizeof(pSh2->planBatch_us));
+#endif
+#if SH2_WITH_BACKPRESSURE
+            pSh2->bpLevel = 0;
+            pSh2->bpRetry = false;
+#endif
             
             // Send reset event to SH2 operation processor.
             // Some commands may handle themselves.  Most will be aborted with SH2_ERR.
             opOnReset(pSh2);
 
+#if SH2_WITH_RECOVERY
+            if (pSh2->recState == RECOVERY_RESET_WAIT) {
+                // Session recovery restores the configuration and reports it.
+                break;
+            }
+            memset(pSh2->sensorConfig, 0, sizeof(pSh2->sensorConfig));
+#endif
+
             // Notify client that reset is complete.
             sh2AsyncEvent.eventId = SH2_RESET;
-            if (pSh2->eventCallback) {
-                pSh2->eventCallback(pSh2->eventCookie, &sh2AsyncEvent);
-            }
+            deliverAsyncEvent(pSh2, &sh2AsyncEvent);
             break;
         default:
             pSh2->execBadPayload++;
@@ -1001,6 +1499,32 @@ const sh2_Op_t setSensorConfigOp = {
     .start = setSensorConfigStart,
 };
 
+// Send a sensor configuration and keep the driver's records of it.
+static int setSensorConfig(sh2_t *pSh2, sh2_SensorId_t sensorId, const sh2_SensorConfig_t *pConfig)
+{
+    // clear opData
+    memset(&pSh2->opData, 0, sizeof(sh2_OpData_t));
+    
+    // Set up operation
+    pSh2->opData.setSensorConfig.sensorId = sensorId;
+    pSh2->opData.setSensorConfig.pConfig = pConfig;
+
+    int rc = opProcess(pSh2, &setSensorConfigOp);
+    if (rc == SH2_OK) {
+        planSensor(pSh2, sensorId, pConfig->reportInterval_us, pConfig->batchInterval_us);
+        if (sensorId <= SH2_MAX_SENSOR_ID) {
+#if SH2_WITH_WATCHDOG
+            pSh2->wdOnChange[sensorId] = pConfig->changeSensitivityEnabled;
+#endif
+#if SH2_WITH_RECOVERY
+            pSh2->sensorConfig[sensorId] = *pConfig;
+#endif
+        }
+    }
+
+    return rc;
+}
+
 // ------------------------------------------------------------------------
 // Get FRS.
 
@@ -1813,6 +2337,75 @@ const sh2_Op_t sendWheelOp = {
     .timeout_us = 5000000,
 };
 
+// Send queued wheel encoder samples, packing several command reports
+// into one payload.  The hub doesn't respond to wheel requests, so this
+// doesn't disturb the sequence number an operation in progress is
+// waiting on and can run while one is active.
+#if SH2_WHEEL_QUEUE_LEN > 0
+static void wheelFlush(sh2_t *pSh2)
+{
+    CommandReq_t req[SH2_WHEEL_REPORTS_PER_PAYLOAD];
+    sh2_WheelSample_t sample[SH2_WHEEL_REPORTS_PER_PAYLOAD];
+    uint16_t count = 0;
+
+    if ((pSh2->wheelCount == 0) || (pSh2->pShtp == 0)) {
+        return;
+    }
+
+    // Take the samples out of the queue before sending.  Sending services
+    // SHTP, so callbacks may queue more samples meanwhile.
+    while ((count < pSh2->wheelCount) && (count < SH2_WHEEL_REPORTS_PER_PAYLOAD)) {
+        sample[count] = pSh2->wheelQueue[(pSh2->wheelHead + count) % SH2_WHEEL_QUEUE_LEN];
+        count++;
+    }
+    pSh2->wheelHead = (pSh2->wheelHead + count) % SH2_WHEEL_QUEUE_LEN;
+    pSh2->wheelCount -= count;
+
+    memset(req, 0, sizeof(req));
+    for (uint16_t n = 0; n < count; n++) {
+        const sh2_WheelSample_t *pSample = &sample[n];
+        uint8_t *p = req[n].p;
+
+        req[n].reportId = SENSORHUB_COMMAND_REQ;
+        req[n].seq = pSh2->nextCmdSeq + n;
+        req[n].command = SH2_CMD_WHEEL_REQ;
+        p[0] = pSample->wheelIndex;
+        p[1] = (pSample->timestamp >> 0) & 0xFF;
+        p[2] = (pSample->timestamp >> 8) & 0xFF;
+        p[3] = (pSample->timestamp >> 16) & 0xFF;
+        p[4] = (pSample->timestamp >> 24) & 0xFF;
+        p[5] = (pSample->wheelData >> 0) & 0xFF;
+        p[6] = (pSample->wheelData >> 8) & 0xFF;
+        p[7] = pSample->dataType;
+    }
+    pSh2->nextCmdSeq += count;
+
+    if (sendCtrl(pSh2, (uint8_t *)req, count * sizeof(CommandReq_t)) != SH2_OK) {
+        // Put the samples back to try again on the next service.  If the
+        // queue filled up meanwhile, the oldest are dropped as usual.
+        pSh2->wheelStats.sendErrors++;
+        while (count > 0) {
+            count--;
+            if (pSh2->wheelCount == SH2_WHEEL_QUEUE_LEN) {
+                pSh2->wheelStats.overflows++;
+                continue;
+            }
+            pSh2->wheelHead = (pSh2->wheelHead + SH2_WHEEL_QUEUE_LEN - 1) % SH2_WHEEL_QUEUE_LEN;
+            pSh2->wheelQueue[pSh2->wheelHead] = sample[count];
+            pSh2->wheelCount++;
+        }
+        return;
+    }
+
+    pSh2->wheelStats.sent += count;
+    pSh2->wheelStats.payloads++;
+}
+#else
+static void wheelFlush(sh2_t *pSh2)
+{
+    (void)pSh2;  // unused
+}
+#endif
 
 // ------------------------------------------------------------------------
 // SHTP Event Callback
@@ -1824,9 +2417,31 @@ static void shtpEventCallback(void *cookie, shtp_Event_t shtpEvent) {
 
     sh2AsyncEvent.eventId = SH2_SHTP_EVENT;
     sh2AsyncEvent.shtpEvent = shtpEvent;
-    if (pSh2->eventCallback) {
-        pSh2->eventCallback(pSh2->eventCookie, &sh2AsyncEvent);
+    deliverAsyncEvent(pSh2, &sh2AsyncEvent);
+}
+
+// Register SH2 handlers with a newly opened SHTP instance.
+static void listenChannels(sh2_t *pSh2)
+{
+    // Register SHTP event callback
+    shtp_setEventCallback(pSh2->pShtp, shtpEventCallback, pSh2);
+
+    // Register SH2 handlers
+    shtp_listenChan(pSh2->pShtp, CHAN_SENSORHUB_CONTROL, sensorhubControlHdlr, pSh2);
+    shtp_listenChan(pSh2->pShtp, CHAN_SENSORHUB_INPUT, sensorhubInputNormalHdlr, pSh2);
+    shtp_listenChan(pSh2->pShtp, CHAN_SENSORHUB_INPUT_WAKE, sensorhubInputWakeHdlr, pSh2);
+    shtp_listenChan(pSh2->pShtp, CHAN_SENSORHUB_INPUT_GIRV, sensorhubInputGyroRvHdlr, pSh2);
+
+    // Batch flushes too large to reassemble are delivered as they arrive,
+    // and with low latency input so is every other payload.
+    setInputStreaming(pSh2, pSh2->lowLatencyInput ? SHTP_STREAM_ALWAYS : SHTP_STREAM_OVERSIZE);
+    if (pSh2->girvCallback != 0) {
+        shtp_streamChan(pSh2->pShtp, CHAN_SENSORHUB_INPUT_GIRV, SHTP_STREAM_ALWAYS,
+                        girvReportLen, sensorhubInputGirvFastHdlr, pSh2);
     }
+
+    // Register EXECUTABLE handlers
+    shtp_listenChan(pSh2->pShtp, CHAN_EXECUTABLE_DEVICE, executableDeviceHdlr, pSh2);
 }
 
 // ------------------------------------------------------------------------
@@ -1869,24 +2484,14 @@ int sh2_open(sh2_Hal_t *pHal,
     pSh2->sensorCookie = 0;
 
     // Open SHTP layer
-    pSh2->pShtp = shtp_open(pSh2->pHal);
+    pSh2->pShtp = shtp_openBuffers(pSh2->pHal, &shtpBuffers);
     if (pSh2->pShtp == 0) {
         // Error opening SHTP
         return SH2_ERR;
     }
 
-    // Register SHTP event callback
-    shtp_setEventCallback(pSh2->pShtp, shtpEventCallback, pSh2);
-
     // Register with SHTP
-    // Register SH2 handlers
-    shtp_listenChan(pSh2->pShtp, CHAN_SENSORHUB_CONTROL, sensorhubControlHdlr, pSh2);
-    shtp_listenChan(pSh2->pShtp, CHAN_SENSORHUB_INPUT, sensorhubInputNormalHdlr, pSh2);
-    shtp_listenChan(pSh2->pShtp, CHAN_SENSORHUB_INPUT_WAKE, sensorhubInputWakeHdlr, pSh2);
-    shtp_listenChan(pSh2->pShtp, CHAN_SENSORHUB_INPUT_GIRV, sensorhubInputGyroRvHdlr, pSh2);
-
-    // Register EXECUTABLE handlers
-    shtp_listenChan(pSh2->pShtp, CHAN_EXECUTABLE_DEVICE, executableDeviceHdlr, pSh2);
+    listenChannels(pSh2);
 
     // Wait for reset notifications to arrive.
     // The client can't talk to the sensor hub until that happens.
@@ -1898,6 +2503,9 @@ int sh2_open(sh2_Hal_t *pHal,
         shtp_service(pSh2->pShtp);
         now_us = pSh2->pHal->getTimeUs(pSh2->pHal);
     }
+
+    // Service deadlines count from here.
+    pSh2->lastService_us = now_us;
     
     // No errors.
     return SH2_OK;
@@ -1921,33 +2529,1207 @@ void sh2_close(void)
     memset(pSh2, 0, sizeof(sh2_t));
 }
 
-/**
- * @brief Service the SH2 device, reading any data that is available and dispatching callbacks.
- *
- * This function should be called periodically by the host system to service an open sensor hub.
- */
-void sh2_service(void)
+// Take len bytes, 4-byte aligned, from the arena.  0 if it won't fit.
+static uint8_t *carve(uint8_t **ppNext, uint32_t *pRemaining, uint16_t len)
 {
-    sh2_t *pSh2 = &_sh2;
+    uint8_t *p = *ppNext;
+    uint32_t pad = (4 - ((uintptr_t)p & 3)) & 3;
 
-    if (pSh2->pShtp != 0) {
-        shtp_service(pSh2->pShtp);
+    if ((uint32_t)len + pad > *pRemaining) {
+        return 0;
     }
+    *ppNext = p + pad + len;
+    *pRemaining -= pad + len;
+
+    return p + pad;
+}
+
+/**
+ * @brief Choose SHTP buffer sizes and memory for the next sh2_open().
+ *
+ * @param  pConfig Buffer sizes and optional arena, or 0 for the defaults.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setMemoryConfig(const sh2_MemoryConfig_t *pConfig)
+{
+    sh2_t *pSh2 = &_sh2;
+    shtp_Buffers_t b;
+
+    if (pSh2->pShtp != 0) {
+        return SH2_ERR;  // Buffers can't change while open
+    }
+
+    memset(&b, 0, sizeof(b));
+
+    if (pConfig != 0) {
+        uint8_t *pNext = pConfig->pArena;
+        uint32_t remaining = pConfig->arenaLen;
+
+        if ((pNext == 0) &&
+            (pConfig->inTransfer || pConfig->inPayload || pConfig->outTransfer)) {
+            return SH2_ERR_BAD_PARAM;
+        }
+        if (pConfig->inTransfer) {
+            b.pInTransfer = carve(&pNext, &remaining, pConfig->inTransfer);
+            b.inTransferLen = pConfig->inTransfer;
+            if (b.pInTransfer == 0) {
+                return SH2_ERR_BAD_PARAM;
+            }
+        }
+        if (pConfig->inPayload) {
+            b.pInPayload = carve(&pNext, &remaining, pConfig->inPayload);
+            b.inPayloadLen = pConfig->inPayload;
+            if (b.pInPayload == 0) {
+                return SH2_ERR_BAD_PARAM;
+            }
+        }
+        if (pConfig->outTransfer) {
+            b.pOutTransfer = carve(&pNext, &remaining, pConfig->outTransfer);
+            b.outTransferLen = pConfig->outTransfer;
+            if (b.pOutTransfer == 0) {
+                return SH2_ERR_BAD_PARAM;
+            }
+        }
+        arenaBytes = pConfig->arenaLen - remaining;
+    }
+    else {
+        arenaBytes = 0;
+    }
+
+    shtpBuffers = b;
+
+    return SH2_OK;
+}
+
+/**
+ * @brief Report the RAM used by the driver.
+ *
+ * @param  pFootprint Receives the sizes.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getFootprint(sh2_Footprint_t *pFootprint)
+{
+    if (pFootprint == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    pFootprint->sh2Bytes = sizeof(sh2_t) + sizeof(sh2AsyncEvent);
+    pFootprint->shtpBytes = shtp_instanceBytes();
+    pFootprint->arenaBytes = arenaBytes;
+    pFootprint->totalBytes = pFootprint->sh2Bytes + pFootprint->shtpBytes + arenaBytes;
+
+#if SHTP_BUILTIN_BUFFERS
+    pFootprint->inTransfer = shtpBuffers.pInTransfer ? shtpBuffers.inTransferLen : SHTP_IN_TRANSFER_LEN;
+    pFootprint->inPayload = shtpBuffers.pInPayload ? shtpBuffers.inPayloadLen : SHTP_IN_PAYLOAD_LEN;
+    pFootprint->outTransfer = shtpBuffers.pOutTransfer ? shtpBuffers.outTransferLen : SHTP_OUT_TRANSFER_LEN;
+#else
+    pFootprint->inTransfer = shtpBuffers.inTransferLen;
+    pFootprint->inPayload = shtpBuffers.inPayloadLen;
+    pFootprint->outTransfer = shtpBuffers.outTransferLen;
+#endif
+
+    return SH2_OK;
+}
+
+// ------------------------------------------------------------------------
+// Backpressure feedback loop
+
+#if SH2_WITH_BACKPRESSURE
+static uint8_t consumerBacklog(sh2_t *pSh2)
+{
+    uint8_t percent = pSh2->bpAppBacklog;
+
+#if SH2_DEFER_QUEUE_LEN > 0
+    if (pSh2->deferEnabled) {
+        uint32_t queued = (pSh2->deferIn - pSh2->deferOut) * 100 / SH2_DEFER_QUEUE_LEN;
+        if (queued > percent) {
+            percent = (uint8_t)queued;
+        }
+    }
+#endif
+
+    return percent;
+}
+
+// Steps are taken with a hub that may have stopped answering, so unlike
+// the API version this operation gives up.
+const sh2_Op_t backpressureGetConfigOp = {
+    .start = getSensorConfigStart,
+    .rx = getSensorConfigRx,
+    .timeout_us = SH2_BACKPRESSURE_OP_TIMEOUT_US,
+};
+
+// The configuration a step keeps, apart from the report interval.
+static int backpressureConfig(sh2_t *pSh2, uint8_t sensorId, sh2_SensorConfig_t *pConfig)
+{
+#if SH2_WITH_RECOVERY
+    // Set by this driver since the last reset: no need to ask the hub.
+    if (pSh2->sensorConfig[sensorId].reportInterval_us != 0) {
+        *pConfig = pSh2->sensorConfig[sensorId];
+        return SH2_OK;
+    }
+#endif
+
+    memset(&pSh2->opData, 0, sizeof(sh2_OpData_t));
+    pSh2->opData.getSensorConfig.sensorId = sensorId;
+    pSh2->opData.getSensorConfig.pConfig = pConfig;
+
+    return opProcess(pSh2, &backpressureGetConfigOp);
+}
+
+// Apply the report intervals for a backpressure level.
+static int applyBackpressure(sh2_t *pSh2, uint8_t level, uint8_t occupancy)
+{
+    sh2_SensorConfig_t config;
+    int rc;
+
+    if ((pSh2->bpLevel == 0) && !pSh2->bpRetry) {
+        // Leaving the configured rates: remember them.
+        memcpy(pSh2->bpBase_us, pSh2->planInterval_us, sizeof(pSh2->bpBase_us));
+    }
+
+    pSh2->bpLastStep_us = pSh2->pHal->getTimeUs(pSh2->pHal);
+
+    for (unsigned id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+        uint64_t interval_us = pSh2->bpBase_us[id];
+
+        if (interval_us == 0) {
+            continue;
+        }
+        for (unsigned n = 0; n < level; n++) {
+            interval_us *= pSh2->bpConfig.stepFactor;
+        }
+        if (interval_us > UINT32_MAX) {
+            interval_us = UINT32_MAX;
+        }
+
+        rc = backpressureConfig(pSh2, (uint8_t)id, &config);
+        if (rc == SH2_OK) {
+            config.reportInterval_us = (uint32_t)interval_us;
+            rc = setSensorConfig(pSh2, (sh2_SensorId_t)id, &config);
+        }
+        if (rc != SH2_OK) {
+            // Hub not answering: give up the step and retry after the holdoff.
+            pSh2->bpLastStep_us = pSh2->pHal->getTimeUs(pSh2->pHal);
+            pSh2->bpRetry = true;
+            return rc;
+        }
+    }
+
+    pSh2->bpRetry = false;
+    if (level == pSh2->bpLevel) {
+        return SH2_OK;  // Abandoned step undone, nothing to report
+    }
+    pSh2->bpLevel = level;
+
+    sh2AsyncEvent.eventId = SH2_BACKPRESSURE;
+    sh2AsyncEvent.backpressure.level = level;
+    sh2AsyncEvent.backpressure.occupancy = occupancy;
+    deliverAsyncEvent(pSh2, &sh2AsyncEvent);
+
+    return SH2_OK;
+}
+
+static void backpressureCheck(sh2_t *pSh2)
+{
+    uint8_t occupancy;
+    uint32_t now_us;
+
+    // Only from the top level: never inside a callback or operation.
+    if (!pSh2->bpEnabled || pSh2->bpBusy || (pSh2->pOp != 0) || (pSh2->pShtp == 0)) {
+        return;
+    }
+
+    now_us = pSh2->pHal->getTimeUs(pSh2->pHal);
+    if (((pSh2->bpLevel != 0) || pSh2->bpRetry) &&
+        ((now_us - pSh2->bpLastStep_us) < pSh2->bpConfig.holdoff_us)) {
+        return;
+    }
+
+    occupancy = consumerBacklog(pSh2);
+
+    pSh2->bpBusy = true;
+    if ((occupancy >= pSh2->bpConfig.highPercent) &&
+        (pSh2->bpLevel < pSh2->bpConfig.maxSteps)) {
+        applyBackpressure(pSh2, pSh2->bpLevel + 1, occupancy);
+    }
+    else if ((occupancy <= pSh2->bpConfig.lowPercent) && (pSh2->bpLevel > 0)) {
+        applyBackpressure(pSh2, pSh2->bpLevel - 1, occupancy);
+    }
+    else if (pSh2->bpRetry) {
+        // Some sensors may have taken an abandoned step: put them back.
+        applyBackpressure(pSh2, pSh2->bpLevel, occupancy);
+    }
+    pSh2->bpBusy = false;
+}
+#else
+static void backpressureCheck(sh2_t *pSh2)
+{
+    (void)pSh2;  // unused
+}
+#endif
+
+// ------------------------------------------------------------------------
+// Stream liveness watchdog
+
+#if SH2_WITH_WATCHDOG
+// Recovery actions are sent to a hub that may not be answering, so unlike
+// the API versions these operations give up.
+const sh2_Op_t watchdogGetConfigOp = {
+    .start = getSensorConfigStart,
+    .rx = getSensorConfigRx,
+    .timeout_us = SH2_WATCHDOG_OP_TIMEOUT_US,
+};
+
+const sh2_Op_t watchdogFlushOp = {
+    .start = forceFlushStart,
+    .rx = forceFlushRx,
+    .timeout_us = SH2_WATCHDOG_OP_TIMEOUT_US,
+};
+
+// Sensors that report events rather than samples
+static bool eventDriven(uint8_t sensorId)
+{
+    switch (sensorId) {
+        case SH2_TAP_DETECTOR:
+        case SH2_STEP_DETECTOR:
+        case SH2_STEP_COUNTER:
+        case SH2_SIGNIFICANT_MOTION:
+        case SH2_STABILITY_CLASSIFIER:
+        case SH2_SHAKE_DETECTOR:
+        case SH2_FLIP_DETECTOR:
+        case SH2_PICKUP_DETECTOR:
+        case SH2_STABILITY_DETECTOR:
+        case SH2_SLEEP_DETECTOR:
+        case SH2_TILT_DETECTOR:
+        case SH2_POCKET_DETECTOR:
+        case SH2_CIRCLE_DETECTOR:
+        case SH2_IZRO_MOTION_REQUEST:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Send the planned intervals again, keeping the rest of the sensor's
+// configuration as the hub holds it.
+static int watchdogRearm(sh2_t *pSh2, uint8_t sensorId)
+{
+    sh2_SensorConfig_t config;
+    uint32_t interval_us = pSh2->planInterval_us[sensorId];
+    uint32_t batch_us = pSh2->planBatch_us[sensorId];
+    uint32_t last_us = pSh2->wdLast_us[sensorId];
+    int rc;
+
+    memset(&config, 0, sizeof(config));
+    memset(&pSh2->opData, 0, sizeof(sh2_OpData_t));
+    pSh2->opData.getSensorConfig.sensorId = sensorId;
+    pSh2->opData.getSensorConfig.pConfig = &config;
+    rc = opProcess(pSh2, &watchdogGetConfigOp);
+    if (rc == SH2_OK) {
+        config.reportInterval_us = interval_us;
+        config.batchInterval_us = batch_us;
+
+        memset(&pSh2->opData, 0, sizeof(sh2_OpData_t));
+        pSh2->opData.setSensorConfig.sensorId = sensorId;
+        pSh2->opData.setSensorConfig.pConfig = &config;
+        rc = opProcess(pSh2, &setSensorConfigOp);
+    }
+
+    // The hub's answer may have cleared the plan.  Keep what was asked for.
+    planSensor(pSh2, sensorId, interval_us, batch_us);
+    pSh2->wdLast_us[sensorId] = last_us;
+
+    return rc;
+}
+
+// How long a sensor may stay silent, or 0 if it isn't watched.
+static uint32_t watchdogTimeout(sh2_t *pSh2, unsigned id)
+{
+    uint64_t timeout_us = pSh2->planInterval_us[id];
+
+    if ((timeout_us == 0) || pSh2->wdOnChange[id] || eventDriven((uint8_t)id)) {
+        return 0;
+    }
+
+    if (pSh2->planBatch_us[id] > timeout_us) {
+        timeout_us = pSh2->planBatch_us[id];
+    }
+    timeout_us *= pSh2->wdConfig.missedIntervals;
+    if (timeout_us < pSh2->wdConfig.minTimeout_us) {
+        timeout_us = pSh2->wdConfig.minTimeout_us;
+    }
+    if (timeout_us > INT32_MAX) {
+        timeout_us = INT32_MAX;
+    }
+
+    return (uint32_t)timeout_us;
+}
+
+static void watchdogCheck(sh2_t *pSh2)
+{
+    uint32_t now_us;
+
+    // Only from the top level: never inside a callback or operation.
+    if (!pSh2->wdEnabled || pSh2->wdBusy || (pSh2->pOp != 0) || (pSh2->pShtp == 0)) {
+        return;
+    }
+
+    pSh2->wdBusy = true;
+    now_us = pSh2->pHal->getTimeUs(pSh2->pHal);
+
+    for (unsigned id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+        uint32_t timeout_us = watchdogTimeout(pSh2, id);
+
+        if (timeout_us == 0) {
+            pSh2->wdStalled[id] = false;
+            continue;
+        }
+
+        uint32_t silent_us = now_us - pSh2->wdLast_us[id];
+        if (silent_us < timeout_us) {
+            continue;
+        }
+
+        if (!pSh2->wdStalled[id]) {
+            pSh2->wdStalled[id] = true;
+            pSh2->wdRetry_us[id] = now_us - timeout_us;
+
+            sh2AsyncEvent.eventId = SH2_STREAM_STALLED;
+            sh2AsyncEvent.streamStall.sensorId = (uint8_t)id;
+            sh2AsyncEvent.streamStall.silent_us = silent_us;
+            sh2AsyncEvent.streamStall.expected_us = pSh2->planInterval_us[id];
+            deliverAsyncEvent(pSh2, &sh2AsyncEvent);
+        }
+
+        // Retry once per timeout while the stream stays silent.
+        if ((now_us - pSh2->wdRetry_us[id]) < timeout_us) {
+            continue;
+        }
+        pSh2->wdRetry_us[id] = now_us;
+
+        if (pSh2->wdConfig.actions & SH2_WATCHDOG_REARM) {
+            watchdogRearm(pSh2, (uint8_t)id);
+        }
+        if ((pSh2->wdConfig.actions & SH2_WATCHDOG_FLUSH) && (pSh2->pShtp != 0)) {
+            memset(&pSh2->opData, 0, sizeof(sh2_OpData_t));
+            pSh2->opData.forceFlush.sensorId = (uint8_t)id;
+            opProcess(pSh2, &watchdogFlushOp);
+        }
+
+        if (pSh2->pShtp == 0) {
+            // Closed by a callback
+            break;
+        }
+    }
+
+    pSh2->wdBusy = false;
+}
+#else
+static void watchdogCheck(sh2_t *pSh2)
+{
+    (void)pSh2;  // unused
+}
+#endif
+
+// ------------------------------------------------------------------------
+// Session recovery after HAL failure
+
+#if SH2_WITH_RECOVERY
+static void deliverRecoveryEvent(sh2_t *pSh2, uint32_t eventId, uint32_t now_us)
+{
+    sh2AsyncEvent.eventId = eventId;
+    sh2AsyncEvent.recovery.attempts = pSh2->recAttempts;
+    sh2AsyncEvent.recovery.downtime_us = now_us - pSh2->recStart_us;
+    deliverAsyncEvent(pSh2, &sh2AsyncEvent);
+}
+
+// Close the failed session and wait before the next reopen.
+static void recoveryBackoff(sh2_t *pSh2, uint32_t now_us)
+{
+    if (pSh2->pShtp != 0) {
+        shtp_close(pSh2->pShtp);
+        pSh2->pShtp = 0;
+    }
+
+    pSh2->recState = RECOVERY_BACKOFF;
+    pSh2->recNext_us = now_us + pSh2->recBackoff_us;
+
+    if (pSh2->recBackoff_us < pSh2->recConfig.backoffMax_us / 2) {
+        pSh2->recBackoff_us *= 2;
+    }
+    else {
+        pSh2->recBackoff_us = pSh2->recConfig.backoffMax_us;
+    }
+}
+
+static void sessionLost(sh2_t *pSh2, uint32_t now_us)
+{
+#if SH2_WITH_BACKPRESSURE
+    if ((pSh2->bpLevel != 0) || pSh2->bpRetry) {
+        // Restore the configured rates, not the stepped down ones.
+        for (unsigned id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+            if ((pSh2->bpBase_us[id] != 0) && (pSh2->sensorConfig[id].reportInterval_us != 0)) {
+                pSh2->sensorConfig[id].reportInterval_us = pSh2->bpBase_us[id];
+            }
+        }
+        pSh2->bpLevel = 0;
+        pSh2->bpRetry = false;
+    }
+#endif
+
+    shtp_close(pSh2->pShtp);
+    pSh2->pShtp = 0;
+    pSh2->resetComplete = false;
+
+    pSh2->recStats.outages++;
+    pSh2->recStats.active = true;
+    pSh2->recAttempts = 0;
+    pSh2->recStart_us = now_us;
+    pSh2->recBackoff_us = pSh2->recConfig.backoffMin_us;
+
+    // The first reopen is tried straight away.
+    pSh2->recState = RECOVERY_BACKOFF;
+    pSh2->recNext_us = now_us;
+
+    deliverRecoveryEvent(pSh2, SH2_SESSION_LOST, now_us);
+}
+
+static void recoveryReopen(sh2_t *pSh2, uint32_t now_us)
+{
+    pSh2->recAttempts++;
+    pSh2->recStats.attempts++;
+
+    pSh2->pShtp = shtp_openBuffers(pSh2->pHal, &shtpBuffers);
+    if (pSh2->pShtp == 0) {
+        recoveryBackoff(pSh2, now_us);
+        return;
+    }
+    listenChannels(pSh2);
+
+    pSh2->resetComplete = false;
+    pSh2->recResetSent = false;
+    pSh2->recState = RECOVERY_RESET_WAIT;
+    pSh2->recNext_us = now_us + pSh2->recConfig.resetTimeout_us;
+}
+
+static void sessionRestored(sh2_t *pSh2)
+{
+    sh2_SensorConfig_t config;
+    uint32_t now_us;
+    uint32_t downtime_us;
+
+    pSh2->recState = RECOVERY_IDLE;
+
+    for (unsigned id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+        if (pSh2->sensorConfig[id].reportInterval_us != 0) {
+            config = pSh2->sensorConfig[id];
+            sh2_setSensorConfig((sh2_SensorId_t)id, &config);
+        }
+    }
+
+    now_us = pSh2->pHal->getTimeUs(pSh2->pHal);
+    downtime_us = now_us - pSh2->recStart_us;
+    pSh2->recStats.recoveries++;
+    pSh2->recStats.active = false;
+    pSh2->recStats.lastDowntime_us = downtime_us;
+    pSh2->recStats.totalDowntime_us += downtime_us;
+    if (downtime_us > pSh2->recStats.maxDowntime_us) {
+        pSh2->recStats.maxDowntime_us = downtime_us;
+    }
+
+    deliverRecoveryEvent(pSh2, SH2_SESSION_RESTORED, now_us);
+}
+
+static void recoveryCheck(sh2_t *pSh2)
+{
+    uint32_t now_us;
+
+    // Only from the top level: never inside a callback or operation.
+    if (!pSh2->recEnabled || pSh2->recBusy || (pSh2->pOp != 0) || (pSh2->pHal == 0)) {
+        return;
+    }
+
+    pSh2->recBusy = true;
+    now_us = pSh2->pHal->getTimeUs(pSh2->pHal);
+
+    switch (pSh2->recState) {
+        case RECOVERY_IDLE:
+            if ((pSh2->pShtp != 0) && halFailed(pSh2)) {
+                sessionLost(pSh2, now_us);
+            }
+            break;
+        case RECOVERY_BACKOFF:
+            if ((int32_t)(now_us - pSh2->recNext_us) >= 0) {
+                recoveryReopen(pSh2, now_us);
+            }
+            break;
+        case RECOVERY_RESET_WAIT:
+            if (pSh2->resetComplete) {
+                sessionRestored(pSh2);
+            }
+            else if (halFailed(pSh2)) {
+                recoveryBackoff(pSh2, now_us);
+            }
+            else if ((int32_t)(now_us - pSh2->recNext_us) >= 0) {
+                if (!pSh2->recResetSent) {
+                    // Opening the HAL didn't reset the hub.  Ask it to.
+                    pSh2->recResetSent = true;
+                    pSh2->recNext_us = now_us + pSh2->recConfig.resetTimeout_us;
+                    sendExecutable(pSh2, EXECUTABLE_DEVICE_CMD_RESET);
+                }
+                else {
+                    recoveryBackoff(pSh2, now_us);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+
+    pSh2->recBusy = false;
+}
+#else
+static void recoveryCheck(sh2_t *pSh2)
+{
+    (void)pSh2;  // unused
+}
+#endif
+
+#if SH2_WITH_BACKPRESSURE || SH2_WITH_WATCHDOG || SH2_WITH_RECOVERY
+// Bring *pDeadline_us forward to a timer of sh2_service(), unless the
+// timer expired before the last service call, which handled it.
+static void timerDeadline(sh2_t *pSh2, uint32_t *pDeadline_us, uint32_t timer_us)
+{
+    if (((int32_t)(timer_us - pSh2->lastService_us) > 0) &&
+        ((int32_t)(timer_us - *pDeadline_us) < 0)) {
+        *pDeadline_us = timer_us;
+    }
+}
+#endif
+
+/**
+ * @brief Service the SH2 device, reading any data that is available and dispatching callbacks.
+ *
+ * This function should be called periodically by the host system to service an open sensor hub.
+ */
+void sh2_service(void)
+{
+    sh2_t *pSh2 = &_sh2;
+
+    if (pSh2->pShtp != 0) {
+        int len = shtp_service(pSh2->pShtp);
+        planService(pSh2, len, len > 0);
+        wheelFlush(pSh2);
+        backpressureCheck(pSh2);
+        watchdogCheck(pSh2);
+    }
+
+    recoveryCheck(pSh2);
+}
+
+/**
+ * @brief Suggest when sh2_service() should next be called.
+ *
+ * @param  pDeadline_us Receives the deadline, in the HAL's getTimeUs() time base.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_nextServiceDeadline(uint32_t *pDeadline_us)
+{
+    sh2_t *pSh2 = &_sh2;
+    uint32_t period_us = SH2_PLAN_MAX_PERIOD_US;
+    uint64_t bytesPerSec = 0;
+    uint32_t deadline_us;
+
+    if (pDeadline_us == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+#if SH2_WITH_RECOVERY
+    if (pSh2->recState == RECOVERY_BACKOFF) {
+        *pDeadline_us = pSh2->recNext_us;
+        return SH2_OK;
+    }
+#endif
+
+    if (pSh2->pShtp == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+    // More data may be waiting, or there is something to send.
+    if (pSh2->lastServiceRead || (pSh2->pOp != 0)) {
+        *pDeadline_us = pSh2->pHal->getTimeUs(pSh2->pHal);
+        return SH2_OK;
+    }
+#if SH2_WHEEL_QUEUE_LEN > 0
+    if (pSh2->wheelCount != 0) {
+        *pDeadline_us = pSh2->pHal->getTimeUs(pSh2->pHal);
+        return SH2_OK;
+    }
+#endif
+
+#if SH2_WITH_PLAN
+    // With a poll fd, it says when to read.  Only polling needs the rates.
+    if (sh2_getPollFd() < 0) {
+        for (unsigned id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+            uint32_t interval_us = pSh2->planInterval_us[id];
+            uint32_t latency_us;
+
+            if (interval_us == 0) {
+                continue;
+            }
+
+            // A batching sensor tolerates its batch interval, others expect
+            // each report to be read before the next one.
+            latency_us = pSh2->planBatch_us[id] ? pSh2->planBatch_us[id] : interval_us;
+            if (latency_us < period_us) {
+                period_us = latency_us;
+            }
+
+            bytesPerSec += (uint64_t)getReportLen(id) * 1000000 / interval_us;
+        }
+
+        // One service call reads one transfer.  Keep half of one in hand.
+        if (bytesPerSec != 0) {
+            uint32_t transfer = pSh2->maxTransfer;
+            if (transfer < SH2_PLAN_MIN_TRANSFER) {
+                transfer = SH2_PLAN_MIN_TRANSFER;
+            }
+
+            // Each transfer also carries one base timestamp reference.
+            transfer -= sizeof(BaseTimestampRef_t);
+            uint64_t fill_us = (uint64_t)transfer * 1000000 / 2 / bytesPerSec;
+            if (fill_us < period_us) {
+                period_us = (uint32_t)fill_us;
+            }
+        }
+    }
+#else
+    (void)bytesPerSec;  // unused: sensor rates aren't tracked
+#endif
+
+    if (period_us < SH2_PLAN_MIN_PERIOD_US) {
+        period_us = SH2_PLAN_MIN_PERIOD_US;
+    }
+    deadline_us = pSh2->lastService_us + period_us;
+
+    // Timers checked by sh2_service() and sh2_onReadable()
+#if SH2_WITH_BACKPRESSURE
+    if (pSh2->bpEnabled && ((pSh2->bpLevel != 0) || pSh2->bpRetry)) {
+        timerDeadline(pSh2, &deadline_us, pSh2->bpLastStep_us + pSh2->bpConfig.holdoff_us);
+    }
+#endif
+#if SH2_WITH_WATCHDOG
+    if (pSh2->wdEnabled) {
+        for (unsigned id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+            uint32_t timeout_us = watchdogTimeout(pSh2, id);
+            if (timeout_us != 0) {
+                uint32_t from_us = pSh2->wdStalled[id] ? pSh2->wdRetry_us[id] : pSh2->wdLast_us[id];
+                timerDeadline(pSh2, &deadline_us, from_us + timeout_us);
+            }
+        }
+    }
+#endif
+#if SH2_WITH_RECOVERY
+    if (pSh2->recState == RECOVERY_RESET_WAIT) {
+        timerDeadline(pSh2, &deadline_us, pSh2->recNext_us);
+    }
+#endif
+
+    *pDeadline_us = deadline_us;
+
+    return SH2_OK;
+}
+
+/**
+ * @brief Time until sh2_service() should next be called.
+ *
+ * @param  pDelay_us Receives the time until sh2_nextServiceDeadline(), 0 if it has passed.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_nextServiceDelay(uint32_t *pDelay_us)
+{
+    sh2_t *pSh2 = &_sh2;
+    uint32_t deadline_us;
+
+    if (pDelay_us == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    int rc = sh2_nextServiceDeadline(&deadline_us);
+    if (rc != SH2_OK) {
+        return rc;
+    }
+
+    int32_t delay_us = (int32_t)(deadline_us - pSh2->pHal->getTimeUs(pSh2->pHal));
+    *pDelay_us = (delay_us > 0) ? (uint32_t)delay_us : 0;
+
+    return SH2_OK;
+}
+
+/**
+ * @brief Get a file descriptor that becomes readable when the sensor hub has data.
+ *
+ * @return File descriptor (>= 0) on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getPollFd(void)
+{
+    sh2_t *pSh2 = &_sh2;
+
+    if (pSh2->pShtp == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+    if (pSh2->pHal->getPollFd == 0) {
+        return SH2_ERR;  // HAL can't provide one
+    }
+
+    int fd = pSh2->pHal->getPollFd(pSh2->pHal);
+    if (fd < 0) {
+        return SH2_ERR;
+    }
+
+    return fd;
+}
+
+/**
+ * @brief Service the SH2 device after its poll descriptor became readable.
+ *
+ * @return Number of transfers processed.  Negative value from sh2_err.h on error.
+ */
+int sh2_onReadable(void)
+{
+    sh2_t *pSh2 = &_sh2;
+    int transfers = 0;
+
+    if (pSh2->pShtp == 0) {
+        // Mid-recovery, keep the recovery going.
+        recoveryCheck(pSh2);
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+    // Drain until the HAL has nothing more.  Callbacks may close the
+    // session, so check pShtp each time around.
+    while ((pSh2->pShtp != 0) && (transfers < SH2_MAX_READS_PER_SERVICE)) {
+        int len = shtp_service(pSh2->pShtp);
+        if (len < 0) {
+            recoveryCheck(pSh2);
+            return SH2_ERR_IO;
+        }
+        if (len == 0) {
+            break;
+        }
+        if (len > pSh2->maxTransfer) {
+            pSh2->maxTransfer = len;
+        }
+        transfers++;
+    }
+
+    if (pSh2->pShtp != 0) {
+        planService(pSh2, 0, transfers == SH2_MAX_READS_PER_SERVICE);
+        wheelFlush(pSh2);
+        backpressureCheck(pSh2);
+        watchdogCheck(pSh2);
+    }
+    recoveryCheck(pSh2);
+
+    return transfers;
+}
+
+/**
+ * @brief Register a function to receive sensor events.
+ *
+ * @param  callback A function that will be called each time a sensor event is received.
+ * @param  cookie  A value that will be passed to the sensor callback function.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setSensorCallback(sh2_SensorCallback_t *callback, void *cookie)
+{
+    sh2_t *pSh2 = &_sh2;
+    
+    pSh2->sensorCallback = callback;
+    pSh2->sensorCookie = cookie;
+
+    return SH2_OK;
+}
+
+/**
+ * @brief Deliver input reports as each transfer arrives.
+ *
+ * When enabled, each report in a payload that spans several transfers
+ * is delivered as soon as its own bytes are read, rather than after the
+ * whole payload.  Payloads too large to reassemble are always delivered
+ * this way.  Applies until sh2_close().
+ *
+ * @param  enable true for per-transfer delivery.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setLowLatencyInput(bool enable)
+{
+    sh2_t *pSh2 = &_sh2;
+
+    if (pSh2->pShtp == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+    pSh2->lowLatencyInput = enable;
+    setInputStreaming(pSh2, enable ? SHTP_STREAM_ALWAYS : SHTP_STREAM_OVERSIZE);
+
+    return SH2_OK;
+}
+
+/**
+ * @brief Deliver Gyro Integrated RV reports on a dedicated fast path.
+ *
+ * GIRV transfers are decoded straight from the transfer buffer into a
+ * preallocated sh2_GyroIntegratedRV_t and passed to callback, bypassing
+ * reassembly, sh2_SensorEvent_t and deferred dispatch.  With callback 0,
+ * GIRV reports go to the sensor callback as before.
+ *
+ * @param  callback Function for each GIRV report, or 0.
+ * @param  cookie Passed to callback.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setGirvCallback(sh2_GirvCallback_t *callback, void *cookie)
+{
+    sh2_t *pSh2 = &_sh2;
+
+    if (pSh2->pShtp == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+    pSh2->girvCallback = callback;
+    pSh2->girvCookie = cookie;
+
+    // Every GIRV payload is streamed, so no transfer is copied for reassembly.
+    if (callback != 0) {
+        return shtp_streamChan(pSh2->pShtp, CHAN_SENSORHUB_INPUT_GIRV, SHTP_STREAM_ALWAYS,
+                               girvReportLen, sensorhubInputGirvFastHdlr, pSh2);
+    }
+
+    return shtp_streamChan(pSh2->pShtp, CHAN_SENSORHUB_INPUT_GIRV, SHTP_STREAM_OFF, 0, 0, 0);
+}
+
+/**
+ * @brief Get latency statistics for the GIRV fast path.
+ *
+ * @param  pStats Receives the statistics.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getGirvStats(sh2_GirvStats_t *pStats)
+{
+    sh2_t *pSh2 = &_sh2;
+
+    if (pStats == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    *pStats = pSh2->girvStats;
+    if (pStats->reports != 0) {
+        pStats->mean_us = (uint32_t)(pSh2->girvTotal_us / pStats->reports);
+    }
+
+    return SH2_OK;
+}
+
+/**
+ * @brief Enable the consumer backpressure feedback loop.
+ *
+ * @param  pConfig Loop settings, or 0 to disable the loop and restore rates.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setBackpressure(const sh2_BackpressureConfig_t *pConfig)
+{
+#if SH2_WITH_BACKPRESSURE
+    sh2_t *pSh2 = &_sh2;
+
+    if (pSh2->pShtp == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+    if (pConfig == 0) {
+        if (pSh2->bpLevel != 0) {
+            int rc = applyBackpressure(pSh2, 0, consumerBacklog(pSh2));
+            if (rc != SH2_OK) {
+                return rc;  // Still stepped down, loop left running
+            }
+        }
+        pSh2->bpEnabled = false;
+        pSh2->bpRetry = false;
+        return SH2_OK;
+    }
+
+    if ((pConfig->stepFactor < 2) || (pConfig->lowPercent >= pConfig->highPercent) ||
+        (pConfig->highPercent > 100)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    pSh2->bpConfig = *pConfig;
+    pSh2->bpEnabled = true;
+    if (pSh2->bpLevel > pConfig->maxSteps) {
+        return applyBackpressure(pSh2, pConfig->maxSteps, consumerBacklog(pSh2));
+    }
+
+    return SH2_OK;
+#else
+    return pConfig ? SH2_ERR : SH2_OK;
+#endif
+}
+
+/**
+ * @brief Report the occupancy of the application's own event queue.
+ *
+ * @param  percent Queue occupancy, 0 to 100.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_reportConsumerBacklog(uint8_t percent)
+{
+    if (percent > 100) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+#if SH2_WITH_BACKPRESSURE
+    _sh2.bpAppBacklog = percent;
+#endif
+
+    return SH2_OK;
+}
+
+/**
+ * @brief Enable the stream liveness watchdog.
+ *
+ * @param  pConfig Watchdog settings, or 0 to disable the watchdog.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setWatchdog(const sh2_WatchdogConfig_t *pConfig)
+{
+#if SH2_WITH_WATCHDOG
+    sh2_t *pSh2 = &_sh2;
+
+    if (pSh2->pShtp == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+    if (pConfig == 0) {
+        pSh2->wdEnabled = false;
+        memset(pSh2->wdStalled, 0, sizeof(pSh2->wdStalled));
+        return SH2_OK;
+    }
+
+    if ((pConfig->missedIntervals == 0) ||
+        ((pConfig->actions & ~(SH2_WATCHDOG_REARM | SH2_WATCHDOG_FLUSH)) != 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    if (!pSh2->wdEnabled) {
+        // Count silence from now, not from before the watchdog ran.
+        uint32_t now_us = pSh2->pHal->getTimeUs(pSh2->pHal);
+        for (unsigned id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+            pSh2->wdLast_us[id] = now_us;
+        }
+    }
+
+    pSh2->wdConfig = *pConfig;
+    pSh2->wdEnabled = true;
+
+    return SH2_OK;
+#else
+    if (_sh2.pShtp == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+    return pConfig ? SH2_ERR : SH2_OK;
+#endif
 }
 
 /**
- * @brief Register a function to receive sensor events.
+ * @brief Enable transparent recovery from HAL failure.
  *
- * @param  callback A function that will be called each time a sensor event is received.
- * @param  cookie  A value that will be passed to the sensor callback function.
+ * @param  pConfig Recovery settings, or 0 to disable recovery.
  * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
  */
-int sh2_setSensorCallback(sh2_SensorCallback_t *callback, void *cookie)
+int sh2_setRecovery(const sh2_RecoveryConfig_t *pConfig)
 {
+#if SH2_WITH_RECOVERY
     sh2_t *pSh2 = &_sh2;
-    
-    pSh2->sensorCallback = callback;
-    pSh2->sensorCookie = cookie;
+
+    // Checked by HAL rather than SHTP: the session may be mid-recovery.
+    if (pSh2->pHal == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+    if (pConfig == 0) {
+        if (pSh2->recState != RECOVERY_IDLE) {
+            // Abandon the outage.  sh2 stays closed.
+            if (pSh2->pShtp != 0) {
+                shtp_close(pSh2->pShtp);
+                pSh2->pShtp = 0;
+            }
+            pSh2->recState = RECOVERY_IDLE;
+            pSh2->recStats.active = false;
+        }
+        pSh2->recEnabled = false;
+        return SH2_OK;
+    }
+
+    if ((pConfig->failureLimit == 0) || (pConfig->backoffMin_us == 0) ||
+        (pConfig->backoffMax_us < pConfig->backoffMin_us) || (pConfig->resetTimeout_us == 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    pSh2->recConfig = *pConfig;
+    pSh2->recEnabled = true;
+
+    return SH2_OK;
+#else
+    if (_sh2.pHal == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+    return pConfig ? SH2_ERR : SH2_OK;
+#endif
+}
+
+/**
+ * @brief Get session recovery statistics.
+ *
+ * @param  pStats Receives the statistics.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getRecoveryStats(sh2_RecoveryStats_t *pStats)
+{
+    sh2_t *pSh2 = &_sh2;
+
+    if (pStats == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+    if (pSh2->pHal == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+#if SH2_WITH_RECOVERY
+    *pStats = pSh2->recStats;
+#else
+    memset(pStats, 0, sizeof(sh2_RecoveryStats_t));
+#endif
+
+    return SH2_OK;
+}
+
+/**
+ * @brief Defer sensor and async event callbacks to sh2_dispatchDeferred().
+ *
+ * @param  enable true to queue callbacks, false to call them from sh2_service() again.
+ * @param  notify Optional, called from the service thread after each callback is queued.
+ * @param  cookie A value that will be passed to notify.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setDeferredDispatch(bool enable, sh2_DeferNotify_t *notify, void *cookie)
+{
+#if SH2_DEFER_QUEUE_LEN > 0
+    sh2_t *pSh2 = &_sh2;
+
+    // Only the producer side changes here.  Entries already queued are
+    // left for the dispatch thread, the ring's only consumer.
+    pSh2->deferNotify = notify;
+    pSh2->deferCookie = cookie;
+    pSh2->deferEnabled = enable;
+
+    return SH2_OK;
+#else
+    (void)notify;   // unused
+    (void)cookie;   // unused
+
+    return enable ? SH2_ERR : SH2_OK;
+#endif
+}
+
+/**
+ * @brief Run deferred callbacks.
+ *
+ * @param  max Most callbacks to run, 0 for all that are queued.
+ * @return Number of callbacks run.
+ */
+int sh2_dispatchDeferred(unsigned max)
+{
+#if SH2_DEFER_QUEUE_LEN > 0
+    sh2_t *pSh2 = &_sh2;
+    int count = 0;
+
+    while ((pSh2->deferOut != pSh2->deferIn) &&
+           ((max == 0) || ((unsigned)count < max))) {
+        // Read the entry only after seeing the index that published it.
+        SH2_MEMORY_BARRIER();
+        sh2_Deferred_t *pEntry = &pSh2->deferQueue[pSh2->deferOut % SH2_DEFER_QUEUE_LEN];
+
+        if (pEntry->isSensor) {
+            if (pSh2->sensorCallback != 0) {
+                pSh2->sensorCallback(pSh2->sensorCookie, &pEntry->u.sensor);
+            }
+        }
+        else if (pSh2->eventCallback != 0) {
+            pSh2->eventCallback(pSh2->eventCookie, &pEntry->u.async);
+        }
+
+        // Done with the entry before handing it back.
+        SH2_MEMORY_BARRIER();
+        pSh2->deferOut++;
+        pSh2->deferStats.dispatched++;
+        count++;
+    }
+
+    return count;
+#else
+    (void)max;  // unused
+
+    return 0;
+#endif
+}
+
+/**
+ * @brief Get deferred dispatch statistics.
+ *
+ * @param  pStats Receives the statistics.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getDeferStats(sh2_DeferStats_t *pStats)
+{
+    if (pStats == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+#if SH2_DEFER_QUEUE_LEN > 0
+    sh2_t *pSh2 = &_sh2;
+
+    *pStats = pSh2->deferStats;
+    pStats->depth = pSh2->deferIn - pSh2->deferOut;
+#else
+    memset(pStats, 0, sizeof(sh2_DeferStats_t));
+#endif
+
+    return SH2_OK;
+}
+
+/**
+ * @brief Install hooks for a dedicated service thread.
+ *
+ * @param  pHooks The hooks, or 0 to remove them.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setThreadHooks(const sh2_ThreadHooks_t *pHooks)
+{
+    sh2_t *pSh2 = &_sh2;
+
+    if (pSh2->pShtp == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+    if (pHooks == 0) {
+        memset(&pSh2->threadHooks, 0, sizeof(pSh2->threadHooks));
+    }
+    else {
+        pSh2->threadHooks = *pHooks;
+    }
 
     return SH2_OK;
 }
@@ -2022,6 +3804,21 @@ int sh2_getProdIds(sh2_ProductIds_t *prodIds)
     return opProcess(pSh2, &getProdIdOp);
 }
 
+/**
+ * @brief Get the set of commands the hub has answered since sh2_open().
+ *
+ * Bit n is set once a command response for command id n has been
+ * received, which shows that the firmware implements that command.
+ *
+ * @return Bitmap of answered command ids (0..31).
+ */
+uint32_t sh2_getAnsweredCommands(void)
+{
+    sh2_t *pSh2 = &_sh2;
+
+    return pSh2->cmdAnswered;
+}
+
 /**
  * @brief Get sensor configuration.
  *
@@ -2061,15 +3858,17 @@ int sh2_setSensorConfig(sh2_SensorId_t sensorId, const sh2_SensorConfig_t *pConf
     if (pSh2->pShtp == 0) {
         return SH2_ERR;  // sh2 API isn't open
     }
- 
-    // clear opData
-    memset(&pSh2->opData, 0, sizeof(sh2_OpData_t));
-    
-    // Set up operation
-    pSh2->opData.setSensorConfig.sensorId = sensorId;
-    pSh2->opData.setSensorConfig.pConfig = pConfig;
 
-    return opProcess(pSh2, &setSensorConfigOp);
+    int rc = setSensorConfig(pSh2, sensorId, pConfig);
+#if SH2_WITH_BACKPRESSURE
+    if ((rc == SH2_OK) && (sensorId <= SH2_MAX_SENSOR_ID) &&
+        ((pSh2->bpLevel != 0) || pSh2->bpRetry)) {
+        // Set while stepped down: this is now the rate to step from.
+        pSh2->bpBase_us[sensorId] = pConfig->reportInterval_us;
+    }
+#endif
+
+    return rc;
 }
 
 /**
@@ -2123,6 +3922,179 @@ int sh2_getMetadata(sh2_SensorId_t sensorId, sh2_SensorMetadata_t *pData)
     return status;
 }
 
+/**
+ * @brief Configure sensors with batching chosen to meet latency budgets.
+ *
+ * @param  pBudgets Sensors to configure, with their rates and budgets.
+ * @param  count Number of entries in pBudgets.
+ * @param  pBatch_us Optional, receives the batch interval applied to each sensor.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setLatencyBudgets(const sh2_LatencyBudget_t *pBudgets, unsigned count, uint32_t *pBatch_us)
+{
+    sh2_t *pSh2 = &_sh2;
+    sh2_SensorMetadata_t metadata;
+    uint64_t bytesPerSec = 0;
+    uint32_t bufferBytes = 0;
+    int rc;
+
+    if (pSh2->pShtp == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+    if ((pBudgets == 0) || (count == 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    // Start from each sensor's own budget, limited by its FIFO allotment.
+    uint32_t batch_us[SH2_MAX_SENSOR_ID + 1];
+    bool listed[SH2_MAX_SENSOR_ID + 1];
+    memset(listed, 0, sizeof(listed));
+    for (unsigned n = 0; n < count; n++) {
+        const sh2_LatencyBudget_t *pBudget = &pBudgets[n];
+        uint32_t b = pBudget->maxLatency_us;
+
+        if ((pBudget->sensorId > SH2_MAX_SENSOR_ID) || (pBudget->reportInterval_us == 0) ||
+            listed[pBudget->sensorId]) {
+            return SH2_ERR_BAD_PARAM;
+        }
+        listed[pBudget->sensorId] = true;
+
+        if (sh2_getMetadata(pBudget->sensorId, &metadata) == SH2_OK) {
+            if (metadata.fifoMax != 0) {
+                // Flush at 80% of the records the FIFO can hold for this sensor.
+                uint64_t fill_us = (uint64_t)metadata.fifoMax * pBudget->reportInterval_us * 4 / 5;
+                if (fill_us < b) {
+                    b = (uint32_t)fill_us;
+                }
+            }
+            if (metadata.batchBufferBytes > bufferBytes) {
+                bufferBytes = metadata.batchBufferBytes;
+            }
+        }
+
+        // Batching below one report interval saves nothing.
+        if (b < pBudget->reportInterval_us) {
+            b = 0;
+        }
+        batch_us[pBudget->sensorId] = b;
+
+        if (b != 0) {
+            bytesPerSec += ((uint64_t)getReportLen(pBudget->sensorId) * 1000000) /
+                pBudget->reportInterval_us;
+        }
+    }
+
+#if SH2_WITH_PLAN
+    // Sensors already batching fill the same buffer.
+    for (unsigned id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+        if (!listed[id] && (pSh2->planBatch_us[id] != 0) && (pSh2->planInterval_us[id] != 0)) {
+            bytesPerSec += ((uint64_t)getReportLen((uint8_t)id) * 1000000) /
+                pSh2->planInterval_us[id];
+        }
+    }
+#endif
+
+    // The batch buffer is shared: at 80% full it holds this long of data.
+    if ((bufferBytes != 0) && (bytesPerSec != 0)) {
+        uint64_t shared_us = (uint64_t)bufferBytes * 1000000 * 4 / 5 / bytesPerSec;
+        for (unsigned n = 0; n < count; n++) {
+            uint8_t id = pBudgets[n].sensorId;
+            if (batch_us[id] > shared_us) {
+                batch_us[id] = (uint32_t)shared_us;
+                if (batch_us[id] < pBudgets[n].reportInterval_us) {
+                    batch_us[id] = 0;
+                }
+            }
+        }
+    }
+
+    for (unsigned n = 0; n < count; n++) {
+        const sh2_LatencyBudget_t *pBudget = &pBudgets[n];
+        sh2_SensorConfig_t config;
+
+        // Keep the rest of the sensor's configuration.
+        rc = sh2_getSensorConfig(pBudget->sensorId, &config);
+        if (rc != SH2_OK) {
+            return rc;
+        }
+        config.reportInterval_us = pBudget->reportInterval_us;
+        config.batchInterval_us = batch_us[pBudget->sensorId];
+
+        rc = sh2_setSensorConfig(pBudget->sensorId, &config);
+        if (rc != SH2_OK) {
+            return rc;
+        }
+
+#if SH2_WITH_LATENCY
+        // Start verification afresh.
+        memset(&pSh2->latency[pBudget->sensorId], 0, sizeof(sh2_ReportLatency_t));
+#endif
+
+        if (pBatch_us != 0) {
+            pBatch_us[n] = config.batchInterval_us;
+        }
+    }
+
+    return SH2_OK;
+}
+
+/**
+ * @brief Get the observed age of a sensor's reports on arrival.
+ *
+ * @param  sensorId Which sensor.
+ * @param  pLatency Receives the statistics.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getReportLatency(sh2_SensorId_t sensorId, sh2_ReportLatency_t *pLatency)
+{
+    if ((sensorId > SH2_MAX_SENSOR_ID) || (pLatency == 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+#if SH2_WITH_LATENCY
+    *pLatency = _sh2.latency[sensorId];
+
+    return SH2_OK;
+#else
+    return SH2_ERR;
+#endif
+}
+
+/**
+ * @brief Check observed report latency against budgets.
+ *
+ * @param  pBudgets Budgets as passed to sh2_setLatencyBudgets().
+ * @param  count Number of entries in pBudgets.
+ * @return Number of sensors whose reports exceeded their budget.  Negative value from sh2_err.h on error.
+ */
+int sh2_checkLatencyBudgets(const sh2_LatencyBudget_t *pBudgets, unsigned count)
+{
+#if SH2_WITH_LATENCY
+    sh2_t *pSh2 = &_sh2;
+    int over = 0;
+
+    if (pBudgets == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    for (unsigned n = 0; n < count; n++) {
+        if (pBudgets[n].sensorId > SH2_MAX_SENSOR_ID) {
+            return SH2_ERR_BAD_PARAM;
+        }
+        if (pSh2->latency[pBudgets[n].sensorId].max_us > pBudgets[n].maxLatency_us) {
+            over++;
+        }
+    }
+
+    return over;
+#else
+    (void)pBudgets;  // unused
+    (void)count;     // unused
+
+    return SH2_ERR;
+#endif
+}
+
 /**
  * @brief Get an FRS record.
  *
@@ -2608,6 +4580,78 @@ int sh2_reportWheelEncoder(uint8_t wheelIndex, uint32_t timestamp, int16_t wheel
     return rc;
 }
 
+/**
+ * @brief Queue a wheel position/velocity report for the sensor hub.
+ *
+ * Queued reports are sent from sh2_service(), sh2_onReadable() and
+ * while other operations run, without blocking the caller.
+ *
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_queueWheelEncoder(uint8_t wheelIndex, uint32_t timestamp, int16_t wheelData, uint8_t dataType)
+{
+#if SH2_WHEEL_QUEUE_LEN > 0
+    sh2_t *pSh2 = &_sh2;
+    sh2_WheelSample_t *pSample;
+
+    if (pSh2->pShtp == 0) {
+        return SH2_ERR;  // sh2 API isn't open
+    }
+
+    if (pSh2->wheelCount == SH2_WHEEL_QUEUE_LEN) {
+        // Full: drop the oldest sample, newer data is worth more.
+        pSh2->wheelHead = (pSh2->wheelHead + 1) % SH2_WHEEL_QUEUE_LEN;
+        pSh2->wheelCount--;
+        pSh2->wheelStats.overflows++;
+    }
+
+    pSample = &pSh2->wheelQueue[(pSh2->wheelHead + pSh2->wheelCount) % SH2_WHEEL_QUEUE_LEN];
+    pSample->wheelIndex = wheelIndex;
+    pSample->timestamp = timestamp;
+    pSample->wheelData = wheelData;
+    pSample->dataType = dataType;
+    pSh2->wheelCount++;
+
+    pSh2->wheelStats.queued++;
+    if (pSh2->wheelCount > pSh2->wheelStats.maxDepth) {
+        pSh2->wheelStats.maxDepth = pSh2->wheelCount;
+    }
+
+    return SH2_OK;
+#else
+    (void)wheelIndex;  // unused
+    (void)timestamp;   // unused
+    (void)wheelData;   // unused
+    (void)dataType;    // unused
+
+    return SH2_ERR;
+#endif
+}
+
+/**
+ * @brief Get wheel encoder queue statistics.
+ *
+ * @param  pStats Receives the statistics.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getWheelQueueStats(sh2_WheelQueueStats_t *pStats)
+{
+    if (pStats == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+#if SH2_WHEEL_QUEUE_LEN > 0
+    sh2_t *pSh2 = &_sh2;
+
+    *pStats = pSh2->wheelStats;
+    pStats->depth = pSh2->wheelCount;
+#else
+    memset(pStats, 0, sizeof(sh2_WheelQueueStats_t));
+#endif
+
+    return SH2_OK;
+}
+
 int sh2_saveDeadReckoningCalNow(void){
     sh2_t *pSh2 = &_sh2;
     
@@ -159,7 +159,8 @@ typedef struct sh2_SensorConfig {
     /* Interval in microseconds between asynchronous input reports. */
     uint32_t reportInterval_us;  /**< @brief [uS] Report interval */
 
-    /* Reserved field, not used. */
+    /* Longest the hub may hold reports before sending them.
+     * See sh2_setLatencyBudgets(). */
     uint32_t batchInterval_us;  /**< @brief [uS] Batch interval */
 
     /* Meaning is sensor specific */
@@ -410,6 +411,11 @@ enum sh2_AsyncEventId_e {
     SH2_RESET,
     SH2_SHTP_EVENT,
     SH2_GET_FEATURE_RESP,
+    SH2_BACKPRESSURE,
+    SH2_STREAM_STALLED,
+    SH2_STREAM_RESUMED,
+    SH2_SESSION_LOST,
+    SH2_SESSION_RESTORED,
 };
 typedef enum sh2_AsyncEventId_e sh2_AsyncEventId_t;
 
@@ -430,11 +436,39 @@ typedef struct sh2_SensorConfigResp_e {
     sh2_SensorConfig_t sensorConfig;
 } sh2_SensorConfigResp_t;
 
+/**
+ * @brief Report rate change made by the backpressure feedback loop.
+ */
+typedef struct sh2_Backpressure_s {
+    uint8_t level;      /**< @brief Steps below the configured rates, 0 when restored */
+    uint8_t occupancy;  /**< @brief [%] Consumer backlog that caused the change */
+} sh2_Backpressure_t;
+
+/**
+ * @brief Sensor stream reported by the liveness watchdog.
+ */
+typedef struct sh2_StreamStall_s {
+    uint8_t sensorId;       /**< @brief Sensor that stopped or resumed reporting */
+    uint32_t silent_us;     /**< @brief [uS] Time since the previous report */
+    uint32_t expected_us;   /**< @brief [uS] Expected time between reports */
+} sh2_StreamStall_t;
+
+/**
+ * @brief Progress of session recovery after a HAL failure.
+ */
+typedef struct sh2_Recovery_s {
+    uint32_t attempts;      /**< @brief HAL reopens tried so far in this outage */
+    uint32_t downtime_us;   /**< @brief [uS] Time since the failure was detected */
+} sh2_Recovery_t;
+
 typedef struct sh2_AsyncEvent {
     uint32_t eventId;
     union {
         sh2_ShtpEvent_t shtpEvent;
         sh2_SensorConfigResp_t sh2SensorConfigResp;
+        sh2_Backpressure_t backpressure;
+        sh2_StreamStall_t streamStall;
+        sh2_Recovery_t recovery;
     };
 } sh2_AsyncEvent_t;
 
@@ -445,6 +479,35 @@ typedef void (sh2_EventCallback_t)(void * cookie, sh2_AsyncEvent_t *pEvent);
  * Public API
  **************************************************************************************/
 
+/**
+ * @brief Buffer sizes for the SHTP layer, set before sh2_open().
+ *
+ * Each buffer given a size is carved from pArena in place of the
+ * built-in one; a size of 0 keeps the built-in buffer.  Built-in sizes
+ * are set at compile time (see shtp.h), and the buffers can be compiled
+ * out altogether with SHTP_BUILTIN_BUFFERS 0.
+ */
+typedef struct sh2_MemoryConfig_s {
+    uint8_t *pArena;        /**< @brief Caller memory, or 0 */
+    uint32_t arenaLen;      /**< @brief [bytes] Size of pArena */
+    uint16_t inTransfer;    /**< @brief [bytes] Largest single read from the HAL (UART: at least SH2_HAL_MAX_TRANSFER_IN) */
+    uint16_t inPayload;     /**< @brief [bytes] Largest payload reassembled */
+    uint16_t outTransfer;   /**< @brief [bytes] Largest single write to the HAL */
+} sh2_MemoryConfig_t;
+
+/**
+ * @brief RAM used by the driver.
+ */
+typedef struct sh2_Footprint_s {
+    uint32_t sh2Bytes;      /**< @brief [bytes] SH2 state */
+    uint32_t shtpBytes;     /**< @brief [bytes] SHTP instance, with built-in buffers */
+    uint32_t arenaBytes;    /**< @brief [bytes] Taken from the caller's arena */
+    uint32_t totalBytes;    /**< @brief [bytes] All of the above */
+    uint16_t inTransfer;    /**< @brief [bytes] Buffer sizes in use */
+    uint16_t inPayload;
+    uint16_t outTransfer;
+} sh2_Footprint_t;
+
 /**
  * @brief Open a session with a sensor hub.
  *
@@ -472,6 +535,22 @@ int sh2_open(sh2_Hal_t *pHal,
  */
 void sh2_close(void);
 
+/**
+ * @brief Choose SHTP buffer sizes and memory for the next sh2_open().
+ *
+ * @param  pConfig Buffer sizes and optional arena, or 0 for the defaults.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setMemoryConfig(const sh2_MemoryConfig_t *pConfig);
+
+/**
+ * @brief Report the RAM used by the driver.
+ *
+ * @param  pFootprint Receives the sizes.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getFootprint(sh2_Footprint_t *pFootprint);
+
 /**
  * @brief Service the SH2 device, reading any data that is available and dispatching callbacks.
  *
@@ -480,6 +559,87 @@ void sh2_close(void);
  */
 void sh2_service(void);
 
+/**
+ * @brief Suggest when sh2_service() should next be called.
+ *
+ * For hosts that poll rather than wait for H_INTN, the suggestion is
+ * based on the report and batch intervals of the enabled sensors (as
+ * set with sh2_setSensorConfig() or reported by the hub) and on the
+ * largest transfer observed, so that reports are read within their
+ * interval or batch interval and the hub never has more than half a
+ * transfer's worth queued.  If the last service call found data, an
+ * operation is in progress or wheel samples are queued, the deadline is
+ * now.
+ *
+ * The result is clamped to SH2_PLAN_MIN_PERIOD_US .. SH2_PLAN_MAX_PERIOD_US
+ * after the last service call.  Built with SH2_WITH_PLAN 0, or when
+ * sh2_getPollFd() provides a descriptor to wait on, sensor rates aren't
+ * used and the deadline is SH2_PLAN_MAX_PERIOD_US after it.
+ *
+ * Timers run by sh2_service() and sh2_onReadable() bring the deadline
+ * forward: the stream watchdog's timeouts and retries, the backpressure
+ * holdoff and session recovery's reopen backoff and reset wait.  Event
+ * loops waiting on the descriptor should use the deadline as their
+ * timeout and call sh2_service() when it passes, or these don't run.
+ *
+ * @param  pDeadline_us Receives the deadline, in the HAL's getTimeUs() time
+ *         base.  Compare with (int32_t)(deadline - now) to allow for rollover.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error,
+ *         e.g. SH2_ERR if sh2 isn't open.
+ */
+int sh2_nextServiceDeadline(uint32_t *pDeadline_us);
+
+/**
+ * @brief Time until sh2_service() should next be called.
+ *
+ * sh2_nextServiceDeadline() relative to the HAL's current time, for
+ * event loops that wait with a timeout.
+ *
+ * @param  pDelay_us Receives the delay [uS], 0 if the deadline has passed.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error,
+ *         e.g. SH2_ERR if sh2 isn't open.
+ */
+int sh2_nextServiceDelay(uint32_t *pDelay_us);
+
+/**
+ * @brief Get a file descriptor that becomes readable when the sensor hub has data.
+ *
+ * For use with event loops (poll, epoll, libuv, ...).  When the descriptor
+ * becomes readable, call sh2_onReadable().  Requires a HAL that implements
+ * getPollFd().
+ *
+ * @return File descriptor (>= 0) on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getPollFd(void);
+
+// Limit on transfers handled by one sh2_onReadable() call, so one busy
+// hub can't starve the rest of an event loop.
+#ifndef SH2_MAX_READS_PER_SERVICE
+#define SH2_MAX_READS_PER_SERVICE (32)
+#endif
+
+/**
+ * @brief Service the SH2 device after its poll descriptor became readable.
+ *
+ * Reads and dispatches every transfer that is available without blocking,
+ * up to SH2_MAX_READS_PER_SERVICE of them.
+ *
+ * The descriptor signals the start of new data, not its presence.  When
+ * the limit is reached, more transfers may still be waiting and the
+ * descriptor won't become readable again for them: call sh2_onReadable()
+ * again, after servicing other work if need be, until it returns less
+ * than SH2_MAX_READS_PER_SERVICE.  sh2_nextServiceDeadline() gives the
+ * current time while this is the case.
+ *
+ * During a session recovery outage (see sh2_setRecovery()) there is no
+ * session to read: this drives the recovery as sh2_service() does, and
+ * returns SH2_ERR until the session is restored.
+ *
+ * @return Number of transfers processed, SH2_MAX_READS_PER_SERVICE if more
+ *         may be pending.  Negative value from sh2_err.h on error.
+ */
+int sh2_onReadable(void);
+
 /**
  * @brief Register a function to receive sensor events.
  *
@@ -489,6 +649,307 @@ void sh2_service(void);
  */
 int sh2_setSensorCallback(sh2_SensorCallback_t *callback, void *cookie);
 
+/**
+ * @brief Deliver input reports as each transfer arrives.
+ *
+ * When enabled, each report in a payload that spans several transfers
+ * is delivered as soon as its own bytes are read, rather than after the
+ * whole payload.  Payloads too large to reassemble are always delivered
+ * this way.  Applies until sh2_close().
+ *
+ * @param  enable true for per-transfer delivery.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setLowLatencyInput(bool enable);
+
+/**
+ * @brief Function called for each Gyro Integrated RV report (fast path).
+ *
+ * Called from the transfer read, with the report decoded in place.
+ * pGirv is only valid during the call.
+ */
+struct sh2_GyroIntegratedRV;
+typedef void (sh2_GirvCallback_t)(void *cookie, const struct sh2_GyroIntegratedRV *pGirv,
+                                  uint64_t timestamp_uS);
+
+/**
+ * @brief Time from the GIRV transfer interrupt to its callback.
+ */
+typedef struct sh2_GirvStats_s {
+    uint32_t reports;  /**< @brief Reports delivered on the fast path */
+    uint32_t last_us;  /**< @brief [uS] Latency of the latest report */
+    uint32_t min_us;   /**< @brief [uS] Lowest latency seen */
+    uint32_t max_us;   /**< @brief [uS] Highest latency seen */
+    uint32_t mean_us;  /**< @brief [uS] Mean latency */
+} sh2_GirvStats_t;
+
+/**
+ * @brief Deliver Gyro Integrated RV reports on a dedicated fast path.
+ *
+ * GIRV transfers are decoded straight from the transfer buffer into a
+ * preallocated sh2_GyroIntegratedRV_t and passed to callback, bypassing
+ * reassembly, sh2_SensorEvent_t and deferred dispatch.  With callback 0,
+ * GIRV reports go to the sensor callback as before.
+ *
+ * @param  callback Function for each GIRV report, or 0.
+ * @param  cookie Passed to callback.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setGirvCallback(sh2_GirvCallback_t *callback, void *cookie);
+
+/**
+ * @brief Get latency statistics for the GIRV fast path.
+ *
+ * @param  pStats Receives the statistics.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getGirvStats(sh2_GirvStats_t *pStats);
+
+/**
+ * @brief Function called when a deferred callback has been queued.
+ *
+ * Runs on the thread servicing the hub.  Typically it wakes the thread or
+ * executor that calls sh2_dispatchDeferred().
+ */
+typedef void (sh2_DeferNotify_t)(void *cookie);
+
+/**
+ * @brief Deferred dispatch statistics.
+ */
+typedef struct sh2_DeferStats_s {
+    uint32_t queued;         /**< Callbacks queued */
+    uint32_t dispatched;     /**< Callbacks run by sh2_dispatchDeferred() */
+    uint32_t droppedSensor;  /**< Sensor events dropped, queue full */
+    uint32_t droppedAsync;   /**< Async events dropped, queue full */
+    uint16_t depth;          /**< Callbacks waiting now */
+    uint16_t highWater;      /**< Most callbacks waiting at once */
+} sh2_DeferStats_t;
+
+/**
+ * @brief Backpressure feedback loop settings.
+ */
+typedef struct sh2_BackpressureConfig_s {
+    uint8_t highPercent;   /**< @brief [%] Backlog at which rates step down */
+    uint8_t lowPercent;    /**< @brief [%] Backlog at which rates step back up */
+    uint8_t maxSteps;      /**< @brief Most steps down */
+    uint8_t stepFactor;    /**< @brief Report interval multiplier per step, 2 or more */
+    uint32_t holdoff_us;   /**< @brief [uS] Least time between steps */
+} sh2_BackpressureConfig_t;
+
+/**
+ * @brief Enable the consumer backpressure feedback loop.
+ *
+ * Consumer backlog is the larger of the deferred dispatch queue
+ * occupancy and the latest value given to sh2_reportConsumerBacklog().
+ * When it reaches highPercent, the report interval of every enabled
+ * sensor is multiplied by stepFactor, up to maxSteps times.  When it
+ * falls to lowPercent, the rates step back up until the configured ones
+ * are restored.  Each step is reported as an SH2_BACKPRESSURE async event.
+ *
+ * Steps are taken from sh2_service() and sh2_onReadable(), outside any
+ * callback.  A step keeps the rest of each sensor's configuration: the
+ * last one given to sh2_setSensorConfig() when built with
+ * SH2_WITH_RECOVERY, otherwise a read from the hub that waits up to
+ * SH2_BACKPRESSURE_OP_TIMEOUT_US.  If the hub does not answer, the step
+ * is abandoned and retried after holdoff_us.  A rate set while rates are
+ * stepped down is sent as given and becomes the rate the loop steps from
+ * and restores.
+ *
+ * Built with SH2_WITH_BACKPRESSURE 0, enabling the loop fails with SH2_ERR.
+ *
+ * @param  pConfig Loop settings, or 0 to disable the loop and restore rates.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ *         If rates could not be restored, the loop stays enabled.
+ */
+int sh2_setBackpressure(const sh2_BackpressureConfig_t *pConfig);
+
+/**
+ * @brief Report the occupancy of the application's own event queue.
+ *
+ * @param  percent Queue occupancy, 0 to 100.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_reportConsumerBacklog(uint8_t percent);
+
+#define SH2_WATCHDOG_REARM (0x01)  /**< @brief Resend the sensor's configuration */
+#define SH2_WATCHDOG_FLUSH (0x02)  /**< @brief Force a flush of the sensor's batch */
+
+/**
+ * @brief Stream liveness watchdog settings.
+ */
+typedef struct sh2_WatchdogConfig_s {
+    uint8_t missedIntervals;  /**< @brief Report intervals without data before a stall, 1 or more */
+    uint8_t actions;          /**< @brief SH2_WATCHDOG_... recovery actions on a stall */
+    uint32_t minTimeout_us;   /**< @brief [uS] Least silence treated as a stall */
+} sh2_WatchdogConfig_t;
+
+/**
+ * @brief Enable the stream liveness watchdog.
+ *
+ * Each periodic sensor enabled with sh2_setSensorConfig() is expected to
+ * report at least once per report interval (or batch interval, if
+ * longer).  After missedIntervals of them pass without a report, an
+ * SH2_STREAM_STALLED async event is delivered, followed by
+ * SH2_STREAM_RESUMED when reports return.  Event-driven sensors and
+ * sensors using change sensitivity are not watched.
+ *
+ * While a sensor stays stalled, the recovery actions are retried once
+ * per timeout.  SH2_WATCHDOG_REARM sends the sensor's report and batch
+ * intervals again, SH2_WATCHDOG_FLUSH asks the hub for its batch.
+ * Each action waits up to SH2_WATCHDOG_OP_TIMEOUT_US for a hub that
+ * doesn't answer.
+ *
+ * Checks run from sh2_service() and sh2_onReadable(), outside any
+ * callback.  Built with SH2_WITH_WATCHDOG 0, enabling the watchdog fails
+ * with SH2_ERR.
+ *
+ * @param  pConfig Watchdog settings, or 0 to disable the watchdog.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setWatchdog(const sh2_WatchdogConfig_t *pConfig);
+
+/**
+ * @brief Session recovery settings.
+ */
+typedef struct sh2_RecoveryConfig_s {
+    uint8_t failureLimit;      /**< @brief HAL reads or writes failing in a row that end the session */
+    uint32_t backoffMin_us;    /**< @brief [uS] Wait after the first failed reopen */
+    uint32_t backoffMax_us;    /**< @brief [uS] Longest wait, the wait doubles up to this */
+    uint32_t resetTimeout_us;  /**< @brief [uS] Wait for the hub to report reset after a reopen */
+} sh2_RecoveryConfig_t;
+
+/**
+ * @brief Session recovery statistics.
+ */
+typedef struct sh2_RecoveryStats_s {
+    uint32_t outages;           /**< @brief Sessions lost to HAL failure */
+    uint32_t recoveries;        /**< @brief Sessions restored */
+    uint32_t attempts;          /**< @brief HAL reopens tried, all outages */
+    uint32_t lastDowntime_us;   /**< @brief [uS] Length of the latest outage */
+    uint32_t maxDowntime_us;    /**< @brief [uS] Longest outage */
+    uint64_t totalDowntime_us;  /**< @brief [uS] All outages, restored ones only */
+    bool active;                /**< @brief An outage is in progress */
+} sh2_RecoveryStats_t;
+
+/**
+ * @brief Enable transparent recovery from HAL failure.
+ *
+ * When failureLimit HAL reads or writes fail in a row (device unplugged,
+ * bus error), the session is lost: any operation in progress returns
+ * SH2_ERR_IO, the HAL is closed and SH2_SESSION_LOST is delivered.  The
+ * HAL is then reopened from sh2_service() until it succeeds, waiting
+ * backoffMin_us after the first failed attempt and twice as long after
+ * each one after that, up to backoffMax_us.
+ *
+ * Once reopened, the hub must report a reset within resetTimeout_us.  If
+ * it doesn't, a reset is requested and it gets as long again.  Each sensor
+ * configuration set since the last reset is then sent again and
+ * SH2_SESSION_RESTORED is delivered.  That reset is not reported as
+ * SH2_RESET.  Other hub settings (calibration, tare, FRS changes not yet
+ * saved) are not restored by the driver.
+ *
+ * During an outage, API calls return SH2_ERR as if sh2 were closed and
+ * sh2_getPollFd() has no descriptor.  Keep calling sh2_service() (or
+ * sh2_onReadable()) by sh2_nextServiceDeadline(): it drives the recovery.
+ * Disabling recovery during an outage leaves sh2 closed.
+ *
+ * Reopening the HAL gives it a new poll descriptor.  Event loops waiting
+ * on the old one must call sh2_getPollFd() again on SH2_SESSION_RESTORED
+ * and wait on the result instead.
+ *
+ * Built with SH2_WITH_RECOVERY 0, enabling recovery fails with SH2_ERR
+ * and sh2_getRecoveryStats() reports zeros.
+ *
+ * @param  pConfig Recovery settings, or 0 to disable recovery.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setRecovery(const sh2_RecoveryConfig_t *pConfig);
+
+/**
+ * @brief Get session recovery statistics.
+ *
+ * @param  pStats Receives the statistics.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getRecoveryStats(sh2_RecoveryStats_t *pStats);
+
+/**
+ * @brief Defer sensor and async event callbacks to sh2_dispatchDeferred().
+ *
+ * Normally callbacks run inside sh2_service(), so a slow callback delays
+ * reading the hub.  In deferred mode events are copied into a bounded
+ * queue of SH2_DEFER_QUEUE_LEN entries instead, and the callbacks run
+ * when the application calls sh2_dispatchDeferred(), which may be on a
+ * different thread than sh2_service().  One thread may service while one
+ * other thread dispatches.  When the queue is full, new events are
+ * dropped and counted in sh2_DeferStats_t.
+ *
+ * Call after sh2_open(), from the thread that services the hub.
+ * Disabling stops queueing only: callbacks already queued still run from
+ * sh2_dispatchDeferred(), so keep calling it until it returns 0.  Until
+ * then they may run after newer callbacks made directly by sh2_service().
+ *
+ * @param  enable true to queue callbacks, false to call them from sh2_service() again.
+ * @param  notify Optional, called from the service thread after each callback is queued.
+ * @param  cookie A value that will be passed to notify.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setDeferredDispatch(bool enable, sh2_DeferNotify_t *notify, void *cookie);
+
+/**
+ * @brief Run deferred callbacks.
+ *
+ * @param  max Most callbacks to run, 0 for all that are queued.
+ * @return Number of callbacks run.
+ */
+int sh2_dispatchDeferred(unsigned max);
+
+/**
+ * @brief Get deferred dispatch statistics.
+ *
+ * @param  pStats Receives the statistics.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getDeferStats(sh2_DeferStats_t *pStats);
+
+/**
+ * @brief Hooks for hosts that run sh2 on one service thread.
+ */
+typedef struct sh2_ThreadHooks_s {
+    /**
+     * @brief Optional, may be 0.  Returns true if the calling thread may
+     * talk to the hub.
+     */
+    bool (*isOwner)(void *cookie);
+
+    /**
+     * @brief Optional, may be 0.  Returns once the hub may have data, or
+     * after at most timeout_us (UINT32_MAX: no limit).
+     */
+    void (*wait)(void *cookie, uint32_t timeout_us);
+
+    void *cookie;
+} sh2_ThreadHooks_t;
+
+/**
+ * @brief Install hooks for a dedicated service thread.
+ *
+ * Calls that exchange messages with the hub (sh2_getSensorConfig(),
+ * sh2_setSensorConfig(), sh2_getProdIds(), FRS access, commands, ...)
+ * check isOwner first and fail with SH2_ERR on any other thread.  While
+ * such a call waits for the hub's answer and a HAL read finds nothing,
+ * it calls wait rather than polling the HAL continuously.  wait must
+ * return often enough for HAL housekeeping done in read(), such as paced
+ * UART transmission.
+ *
+ * Call after sh2_open(), from the thread that services the hub.
+ * sh2_close() removes the hooks.
+ *
+ * @param  pHooks The hooks, or 0 to remove them.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setThreadHooks(const sh2_ThreadHooks_t *pHooks);
+
 /**
  * @brief Reset the sensor hub device by sending RESET (1) command on "device" channel.
  *
@@ -518,6 +979,16 @@ int sh2_devSleep(void);
  */
 int sh2_getProdIds(sh2_ProductIds_t *prodIds);
 
+/**
+ * @brief Get the set of commands the hub has answered since sh2_open().
+ *
+ * Bit n is set once a command response for command id n has been
+ * received, which shows that the firmware implements that command.
+ *
+ * @return Bitmap of answered command ids (0..31).
+ */
+uint32_t sh2_getAnsweredCommands(void);
+
 /**
  * @brief Get sensor configuration.
  *
@@ -545,6 +1016,75 @@ int sh2_setSensorConfig(sh2_SensorId_t sensorId, const sh2_SensorConfig_t *pConf
  */
 int sh2_getMetadata(sh2_SensorId_t sensorId, sh2_SensorMetadata_t *pData);
 
+/**
+ * @brief A sensor's report rate and the longest it may wait in the hub.
+ */
+typedef struct sh2_LatencyBudget_s {
+    sh2_SensorId_t sensorId;
+    uint32_t reportInterval_us;  /**< @brief [uS] Report interval */
+    uint32_t maxLatency_us;      /**< @brief [uS] Longest a report may be held before delivery */
+} sh2_LatencyBudget_t;
+
+/**
+ * @brief Observed age of a sensor's reports on arrival at the host.
+ *
+ * Age is measured from sample time to the host interrupt, from the
+ * timestamp information in each batch.
+ */
+typedef struct sh2_ReportLatency_s {
+    uint32_t reports;  /**< @brief Reports measured */
+    uint32_t last_us;  /**< @brief [uS] Age of the latest report */
+    uint32_t max_us;   /**< @brief [uS] Oldest report seen */
+} sh2_ReportLatency_t;
+
+/**
+ * @brief Configure sensors with batching chosen to meet latency budgets.
+ *
+ * Each sensor is enabled at its report interval with the longest batch
+ * interval its budget allows, so the hub interrupts the host as rarely
+ * as possible.  Where the sensor metadata gives fifoMax or
+ * batchBufferBytes, batch intervals are shortened so the hub's FIFO is
+ * flushed at 80% full rather than overflowing.  The shared buffer
+ * estimate includes sensors already batching, when built with
+ * SH2_WITH_PLAN.  Budgets shorter than the report interval disable
+ * batching for that sensor.
+ *
+ * Only the report and batch intervals change: the rest of each sensor's
+ * configuration is read from the hub and kept.  Each sensor may be
+ * listed once; a repeated sensorId fails with SH2_ERR_BAD_PARAM.
+ *
+ * Latency statistics for the configured sensors are cleared, so the
+ * result can be verified with sh2_checkLatencyBudgets() once reports
+ * have flowed for a while.
+ *
+ * @param  pBudgets Sensors to configure, with their rates and budgets.
+ * @param  count Number of entries in pBudgets.
+ * @param  pBatch_us Optional, receives the batch interval applied to each sensor.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_setLatencyBudgets(const sh2_LatencyBudget_t *pBudgets, unsigned count, uint32_t *pBatch_us);
+
+/**
+ * @brief Get the observed age of a sensor's reports on arrival.
+ *
+ * Returns SH2_ERR if built with SH2_WITH_LATENCY 0, as does
+ * sh2_checkLatencyBudgets().
+ *
+ * @param  sensorId Which sensor.
+ * @param  pLatency Receives the statistics.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getReportLatency(sh2_SensorId_t sensorId, sh2_ReportLatency_t *pLatency);
+
+/**
+ * @brief Check observed report latency against budgets.
+ *
+ * @param  pBudgets Budgets as passed to sh2_setLatencyBudgets().
+ * @param  count Number of entries in pBudgets.
+ * @return Number of sensors whose reports exceeded their budget.  Negative value from sh2_err.h on error.
+ */
+int sh2_checkLatencyBudgets(const sh2_LatencyBudget_t *pBudgets, unsigned count);
+
 /**
  * @brief Get an FRS record.
  *
@@ -735,6 +1275,46 @@ int sh2_setIZro(sh2_IZroMotionIntent_t intent);
  */
 int sh2_reportWheelEncoder(uint8_t wheelIndex, uint32_t timestamp, int16_t wheelData, uint8_t dataType);
 
+/**
+ * @brief Wheel encoder queue statistics.
+ */
+typedef struct sh2_WheelQueueStats_s {
+    uint32_t queued;      /**< Samples accepted */
+    uint32_t sent;        /**< Samples sent to the hub */
+    uint32_t payloads;    /**< SHTP payloads used to send them */
+    uint32_t overflows;   /**< Oldest samples dropped because the queue was full */
+    uint32_t sendErrors;  /**< Failed sends, retried later */
+    uint16_t depth;       /**< Samples currently queued */
+    uint16_t maxDepth;    /**< Most samples queued at once */
+} sh2_WheelQueueStats_t;
+
+/**
+ * @brief Queue a wheel position/velocity report for the sensor hub.
+ *
+ * Unlike sh2_reportWheelEncoder(), this does not block.  Samples are sent
+ * from sh2_service(), sh2_onReadable() and while other operations are in
+ * progress, several per SHTP payload.  If the queue is full, the oldest
+ * sample is dropped and counted in sh2_WheelQueueStats_t.overflows.
+ * Built with SH2_WHEEL_QUEUE_LEN 0 there is no queue, and this returns
+ * SH2_ERR.
+ *
+ * @parameter wheelIndex platform-dependent: 0= left, 1= right for
+ *   typical differential drive robot
+ * @parameter timestamp microsecond timestamp (hub scale) of measurement
+ * @parameter wheelData raw wheel position or velocity
+ * @parameter dataType 0 if data is position, 1 if data is velocity
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_queueWheelEncoder(uint8_t wheelIndex, uint32_t timestamp, int16_t wheelData, uint8_t dataType);
+
+/**
+ * @brief Get wheel encoder queue statistics.
+ *
+ * @param  pStats Receives the statistics.
+ * @return SH2_OK (0), on success.  Negative value from sh2_err.h on error.
+ */
+int sh2_getWheelQueueStats(sh2_WheelQueueStats_t *pStats);
+
 /**
  * @brief Save Dead Reckoning Calibration Data to flash.
  *
@@ -74,9 +74,86 @@ static int decodeRawOptFlow(sh2_SensorValue_t *value, const sh2_SensorEvent_t *e
 static int decodeDeadReckoningPose(sh2_SensorValue_t *value, const sh2_SensorEvent_t *event);
 static int decodeWheelEncoder(sh2_SensorValue_t *value, const sh2_SensorEvent_t *event);
 
+static int vectorAxes(float *pAxes, float x, float y, float z)
+{
+    pAxes[0] = x;
+    pAxes[1] = y;
+    pAxes[2] = z;
+
+    return 3;
+}
+
+static int quaternionAxes(float *pAxes, float i, float j, float k, float real)
+{
+    pAxes[0] = i;
+    pAxes[1] = j;
+    pAxes[2] = k;
+    pAxes[3] = real;
+
+    return 4;
+}
+
 // ------------------------------------------------------------------------
 // Public API
 
+void sh2_decodeGyroIntegratedRV(sh2_GyroIntegratedRV_t *pGirv, const uint8_t *pReport)
+{
+    pGirv->i = read16(&pReport[0]) * SCALE_Q(14);
+    pGirv->j = read16(&pReport[2]) * SCALE_Q(14);
+    pGirv->k = read16(&pReport[4]) * SCALE_Q(14);
+    pGirv->real = read16(&pReport[6]) * SCALE_Q(14);
+    pGirv->angVelX = read16(&pReport[8]) * SCALE_Q(10);
+    pGirv->angVelY = read16(&pReport[10]) * SCALE_Q(10);
+    pGirv->angVelZ = read16(&pReport[12]) * SCALE_Q(10);
+}
+
+int sh2_getAxes(const sh2_SensorValue_t *value, float *pAxes)
+{
+    switch (value->sensorId) {
+        case SH2_ACCELEROMETER:
+            return vectorAxes(pAxes, value->un.accelerometer.x, value->un.accelerometer.y,
+                              value->un.accelerometer.z);
+        case SH2_LINEAR_ACCELERATION:
+            return vectorAxes(pAxes, value->un.linearAcceleration.x, value->un.linearAcceleration.y,
+                              value->un.linearAcceleration.z);
+        case SH2_GRAVITY:
+            return vectorAxes(pAxes, value->un.gravity.x, value->un.gravity.y,
+                              value->un.gravity.z);
+        case SH2_GYROSCOPE_CALIBRATED:
+            return vectorAxes(pAxes, value->un.gyroscope.x, value->un.gyroscope.y,
+                              value->un.gyroscope.z);
+        case SH2_GYROSCOPE_UNCALIBRATED:
+            return vectorAxes(pAxes, value->un.gyroscopeUncal.x, value->un.gyroscopeUncal.y,
+                              value->un.gyroscopeUncal.z);
+        case SH2_MAGNETIC_FIELD_CALIBRATED:
+            return vectorAxes(pAxes, value->un.magneticField.x, value->un.magneticField.y,
+                              value->un.magneticField.z);
+        case SH2_MAGNETIC_FIELD_UNCALIBRATED:
+            return vectorAxes(pAxes, value->un.magneticFieldUncal.x, value->un.magneticFieldUncal.y,
+                              value->un.magneticFieldUncal.z);
+        case SH2_ROTATION_VECTOR:
+            return quaternionAxes(pAxes, value->un.rotationVector.i, value->un.rotationVector.j,
+                                  value->un.rotationVector.k, value->un.rotationVector.real);
+        case SH2_GAME_ROTATION_VECTOR:
+            return quaternionAxes(pAxes, value->un.gameRotationVector.i, value->un.gameRotationVector.j,
+                                  value->un.gameRotationVector.k, value->un.gameRotationVector.real);
+        case SH2_GEOMAGNETIC_ROTATION_VECTOR:
+            return quaternionAxes(pAxes, value->un.geoMagRotationVector.i, value->un.geoMagRotationVector.j,
+                                  value->un.geoMagRotationVector.k, value->un.geoMagRotationVector.real);
+        case SH2_ARVR_STABILIZED_RV:
+            return quaternionAxes(pAxes, value->un.arvrStabilizedRV.i, value->un.arvrStabilizedRV.j,
+                                  value->un.arvrStabilizedRV.k, value->un.arvrStabilizedRV.real);
+        case SH2_ARVR_STABILIZED_GRV:
+            return quaternionAxes(pAxes, value->un.arvrStabilizedGRV.i, value->un.arvrStabilizedGRV.j,
+                                  value->un.arvrStabilizedGRV.k, value->un.arvrStabilizedGRV.real);
+        case SH2_GYRO_INTEGRATED_RV:
+            return quaternionAxes(pAxes, value->un.gyroIntegratedRV.i, value->un.gyroIntegratedRV.j,
+                                  value->un.gyroIntegratedRV.k, value->un.gyroIntegratedRV.real);
+        default:
+            return 0;
+    }
+}
+
 int sh2_decodeSensorEvent(sh2_SensorValue_t *value, const sh2_SensorEvent_t *event)
 {
     // Fill out fields of *value based on *event, converting data from message representation
@@ -545,13 +622,7 @@ static int decodeArvrStabilizedGRV(sh2_SensorValue_t *value, const sh2_SensorEve
 
 static int decodeGyroIntegratedRV(sh2_SensorValue_t *value, const sh2_SensorEvent_t *event)
 {
-    value->un.gyroIntegratedRV.i = read16(&event->report[0]) * SCALE_Q(14);
-    value->un.gyroIntegratedRV.j = read16(&event->report[2]) * SCALE_Q(14);
-    value->un.gyroIntegratedRV.k = read16(&event->report[4]) * SCALE_Q(14);
-    value->un.gyroIntegratedRV.real = read16(&event->report[6]) * SCALE_Q(14);
-    value->un.gyroIntegratedRV.angVelX = read16(&event->report[8]) * SCALE_Q(10);
-    value->un.gyroIntegratedRV.angVelY = read16(&event->report[10]) * SCALE_Q(10);
-    value->un.gyroIntegratedRV.angVelZ = read16(&event->report[12]) * SCALE_Q(10);
+    sh2_decodeGyroIntegratedRV(&value->un.gyroIntegratedRV, event->report);
 
     return SH2_OK;
 }
@@ -542,4 +542,12 @@ typedef struct sh2_SensorValue {
 
 int sh2_decodeSensorEvent(sh2_SensorValue_t *value, const sh2_SensorEvent_t *event);
 
+// Decode one 14-byte report from the GIRV channel, which has no report id.
+void sh2_decodeGyroIntegratedRV(sh2_GyroIntegratedRV_t *pGirv, const uint8_t *pReport);
+
+// Copy the axes of a vector (x, y, z) or quaternion (i, j, k, real) sensor
+// into pAxes, which has room for 4.  Returns the number of axes, or 0 for
+// sensors of other kinds.
+int sh2_getAxes(const sh2_SensorValue_t *value, float *pAxes);
+
 #endif
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Hub capability detection with a cache keyed by firmware.
+ */
+
+#include "sh2_caps.h"
+#include "sh2_err.h"
+
+#include <string.h>
+
+// ------------------------------------------------------------------------
+// Private definitions
+
+// Longest FRS record read by the probe.  getFrs() may store two words
+// past the size it is given.
+#define PROBE_FRS_WORDS (72)
+
+static const uint16_t probeFrs[SH2_CAPS_FRS_RECORDS] = {
+    SYSTEM_ORIENTATION,
+    ACCEL_ORIENTATION,
+    GYROSCOPE_ORIENTATION,
+    MAGNETOMETER_ORIENTATION,
+    ARVR_STABILIZATION_RV,
+    ARVR_STABILIZATION_GRV,
+    TAP_DETECT_CONFIG,
+    SIG_MOTION_DETECT_CONFIG,
+    SHAKE_DETECT_CONFIG,
+    MAX_FUSION_PERIOD,
+    SERIAL_NUMBER,
+    USER_RECORD,
+    ME_TIME_SOURCE_SELECT,
+    UART_FORMAT,
+    GYRO_INTEGRATED_RV_CONFIG,
+    DR_WHEEL_CONFIG,
+};
+
+// ------------------------------------------------------------------------
+// Private functions
+
+// Two product id lists describe the same firmware.  The reset cause
+// is left out: it changes from one boot to the next.
+static bool sameFirmware(const sh2_ProductIds_t *a, const sh2_ProductIds_t *b)
+{
+    if (a->numEntries != b->numEntries) {
+        return false;
+    }
+
+    for (unsigned n = 0; n < a->numEntries; n++) {
+        const sh2_ProductId_t *pA = &a->entry[n];
+        const sh2_ProductId_t *pB = &b->entry[n];
+
+        if ((pA->swPartNumber != pB->swPartNumber) ||
+            (pA->swVersionMajor != pB->swVersionMajor) ||
+            (pA->swVersionMinor != pB->swVersionMinor) ||
+            (pA->swVersionPatch != pB->swVersionPatch) ||
+            (pA->swBuildNumber != pB->swBuildNumber)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Probe results: SH2_ERR_HUB means the hub doesn't know the record and
+// SH2_ERR_BAD_PARAM that the driver has none for this sensor.  Anything
+// else that fails (a reset, lost data) ends discovery.
+static bool probeFailed(int rc)
+{
+    return (rc != SH2_OK) && (rc != SH2_ERR_HUB) && (rc != SH2_ERR_BAD_PARAM);
+}
+
+static int probeSensors(sh2_Caps_t *pCaps)
+{
+    sh2_SensorMetadata_t metadata;
+
+    for (unsigned id = 1; id <= SH2_MAX_SENSOR_ID; id++) {
+        int rc = sh2_getMetadata((sh2_SensorId_t)id, &metadata);
+        if (probeFailed(rc)) {
+            return rc;
+        }
+        if (rc == SH2_OK) {
+            pCaps->sensors[id / 8] |= (uint8_t)(1 << (id % 8));
+        }
+    }
+
+    return SH2_OK;
+}
+
+static int probeRecords(sh2_Caps_t *pCaps)
+{
+    uint32_t data[PROBE_FRS_WORDS + 2];
+
+    for (unsigned n = 0; n < SH2_CAPS_FRS_RECORDS; n++) {
+        uint16_t words = PROBE_FRS_WORDS;
+
+        // An empty record is still a supported one.
+        int rc = sh2_getFrs(probeFrs[n], data, &words);
+        if (probeFailed(rc)) {
+            return rc;
+        }
+        if (rc == SH2_OK) {
+            pCaps->frs |= (uint16_t)(1 << n);
+        }
+    }
+
+    return SH2_OK;
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+void sh2_capsCacheInit(sh2_CapsCache_t *pCache)
+{
+    memset(pCache, 0, sizeof(sh2_CapsCache_t));
+}
+
+int sh2_capsDetect(sh2_CapsCache_t *pCache, uint8_t probeFlags,
+                   const sh2_Caps_t **ppCaps, bool *pFromCache)
+{
+    sh2_ProductIds_t prodIds;
+    sh2_Caps_t *pCaps;
+    int rc;
+
+    if ((pCache == 0) || (ppCaps == 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+    if (pFromCache != 0) {
+        *pFromCache = false;
+    }
+
+    memset(&prodIds, 0, sizeof(prodIds));
+    rc = sh2_getProdIds(&prodIds);
+    if (rc != SH2_OK) {
+        return rc;
+    }
+    for (unsigned n = 0; n < prodIds.numEntries; n++) {
+        prodIds.entry[n].resetCause = 0;
+    }
+
+    // Known firmware, probed at least as far as now asked?
+    unsigned slot = pCache->next;
+    bool known = false;
+    for (unsigned n = 0; n < SH2_CAPS_CACHE_ENTRIES; n++) {
+        pCaps = &pCache->entry[n];
+        if (pCaps->valid && sameFirmware(&pCaps->prodIds, &prodIds)) {
+            if ((pCaps->probed & probeFlags) == probeFlags) {
+                pCache->active = n;
+                sh2_capsUpdate(pCache);
+                *ppCaps = pCaps;
+                if (pFromCache != 0) {
+                    *pFromCache = true;
+                }
+                return SH2_OK;
+            }
+            slot = n;
+            known = true;
+            break;
+        }
+    }
+
+    // Discover into the entry for this firmware, or else the oldest one.
+    // A new entry stays invalid until complete.  A known one keeps what
+    // it has learned and only probes what is missing.
+    pCache->active = slot;
+    pCaps = &pCache->entry[slot];
+    if (!known) {
+        pCache->next = (pCache->next + 1) % SH2_CAPS_CACHE_ENTRIES;
+        memset(pCaps, 0, sizeof(sh2_Caps_t));
+        pCaps->prodIds = prodIds;
+    }
+    uint8_t missing = probeFlags & ~pCaps->probed;
+
+    if (missing & SH2_CAPS_PROBE_SENSORS) {
+        memset(pCaps->sensors, 0, sizeof(pCaps->sensors));
+        rc = probeSensors(pCaps);
+        if (rc != SH2_OK) {
+            return rc;
+        }
+        pCaps->probed |= SH2_CAPS_PROBE_SENSORS;
+    }
+    if (missing & SH2_CAPS_PROBE_FRS) {
+        pCaps->frs = 0;
+        rc = probeRecords(pCaps);
+        if (rc != SH2_OK) {
+            return rc;
+        }
+        pCaps->probed |= SH2_CAPS_PROBE_FRS;
+    }
+
+    pCaps->valid = true;
+    sh2_capsUpdate(pCache);
+    *ppCaps = pCaps;
+
+    return SH2_OK;
+}
+
+void sh2_capsUpdate(sh2_CapsCache_t *pCache)
+{
+    sh2_Caps_t *pCaps = &pCache->entry[pCache->active];
+
+    if (pCaps->valid) {
+        pCaps->commands |= sh2_getAnsweredCommands();
+    }
+}
+
+bool sh2_capsHasSensor(const sh2_Caps_t *pCaps, sh2_SensorId_t sensorId)
+{
+    if (sensorId > SH2_MAX_SENSOR_ID) {
+        return false;
+    }
+
+    return (pCaps->sensors[sensorId / 8] & (1 << (sensorId % 8))) != 0;
+}
+
+bool sh2_capsHasFrs(const sh2_Caps_t *pCaps, uint16_t recordId)
+{
+    for (unsigned n = 0; n < SH2_CAPS_FRS_RECORDS; n++) {
+        if (probeFrs[n] == recordId) {
+            return (pCaps->frs & (1 << n)) != 0;
+        }
+    }
+
+    // Not in the probe table
+    return false;
+}
+
+bool sh2_capsHasCommand(const sh2_Caps_t *pCaps, uint8_t command)
+{
+    if (command >= 32) {
+        return false;
+    }
+
+    return (pCaps->commands & (1u << command)) != 0;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Hub capability detection with a cache keyed by firmware.
+ *
+ * sh2_capsDetect() reads the product ids and, the first time a given
+ * firmware is seen, probes which sensors and FRS records it supports.
+ * The result is kept in an sh2_CapsCache_t so later opens of the same
+ * part and version cost only the product id query.  The cache is plain
+ * data and may be saved to non-volatile storage between runs.
+ *
+ * Command support is not probed: an unanswered command op never
+ * completes.  Instead, sh2_capsUpdate() records the commands the hub
+ * has answered so far, and the cache learns them over time.
+ *
+ * A hub reset within a session doesn't change the firmware, so the
+ * capabilities found at open remain valid after SH2_RESET.
+ */
+
+#ifndef SH2_CAPS_H
+#define SH2_CAPS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sh2.h"
+
+#ifndef SH2_CAPS_CACHE_ENTRIES
+#define SH2_CAPS_CACHE_ENTRIES (2)
+#endif
+
+// What sh2_capsDetect() probes on a cache miss
+#define SH2_CAPS_PROBE_SENSORS (0x01)  // Metadata record per sensor id
+#define SH2_CAPS_PROBE_FRS     (0x02)  // Configuration FRS records
+
+// Configuration FRS records covered by the FRS probe, see sh2_capsHasFrs()
+#define SH2_CAPS_FRS_RECORDS (16)
+
+typedef struct sh2_Caps_s {
+    bool valid;
+    uint8_t probed;                     // SH2_CAPS_PROBE_... bits
+    sh2_ProductIds_t prodIds;           // resetCause of each entry is cleared
+    uint8_t sensors[(SH2_MAX_SENSOR_ID + 8) / 8];
+    uint16_t frs;                       // Bit per record in the FRS probe table
+    uint32_t commands;                  // Bit per command id answered
+} sh2_Caps_t;
+
+typedef struct sh2_CapsCache_s {
+    sh2_Caps_t entry[SH2_CAPS_CACHE_ENTRIES];
+    uint8_t next;                       // Entry replaced on the next miss
+    uint8_t active;                     // Entry for the connected hub
+} sh2_CapsCache_t;
+
+// Empty the cache.
+void sh2_capsCacheInit(sh2_CapsCache_t *pCache);
+
+// Identify the hub and find its capabilities.  Call after sh2_open()
+// once the hub has reset.  On a cache hit only the product ids are
+// read; otherwise the probes in probeFlags run and the result replaces
+// the oldest entry.  *ppCaps points into the cache.  *pFromCache, if not
+// NULL, tells whether discovery was skipped.
+int sh2_capsDetect(sh2_CapsCache_t *pCache, uint8_t probeFlags,
+                   const sh2_Caps_t **ppCaps, bool *pFromCache);
+
+// Merge the commands answered since sh2_open() into the active entry.
+void sh2_capsUpdate(sh2_CapsCache_t *pCache);
+
+bool sh2_capsHasSensor(const sh2_Caps_t *pCaps, sh2_SensorId_t sensorId);
+bool sh2_capsHasFrs(const sh2_Caps_t *pCaps, uint16_t recordId);
+bool sh2_capsHasCommand(const sh2_Caps_t *pCaps, uint8_t command);
+
+#endif
@@ -94,6 +94,26 @@ struct sh2_Hal_s {
     // microsecond counter.  The count may roll over after 2^32
     // microseconds.  
     uint32_t (*getTimeUs)(sh2_Hal_t *self);
+
+    // Optional, may be 0.
+    // On systems with file descriptor based event loops (poll, epoll,
+    // libuv, ...) this function should return a descriptor that becomes
+    // readable when the sensor hub has data to deliver, e.g. a GPIO line
+    // event fd for H_INTN, or the tty fd of a UART.  Return -1 if no such
+    // descriptor exists.
+    //
+    // When this is used, read() must not block waiting for data.
+    int (*getPollFd)(sh2_Hal_t *self);
+
+    // Optional, may be 0.
+    // Alternative to read() with a 64-bit microsecond timestamp that does
+    // not roll over.  If provided, it is used in place of read().
+    //
+    // Hosts that can capture the interrupt time outside of the HAL's own
+    // scheduling (e.g. the kernel timestamp of a GPIO line event) should
+    // provide this, so sensor event timestamps are free of the delay
+    // between the interrupt and the call to read().
+    int (*readTs)(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint64_t *t_us);
 };
 
 // End of include guard
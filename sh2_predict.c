@@ -0,0 +1,264 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Orientation prediction.
+ */
+
+#include "sh2_predict.h"
+#include "sh2_err.h"
+
+#include <math.h>
+#include <string.h>
+
+// ------------------------------------------------------------------------
+// Private definitions
+
+// Orders state writes against the sequence count for readers on
+// other threads.
+#ifndef SH2_MEMORY_BARRIER
+#if defined(__GNUC__)
+#define SH2_MEMORY_BARRIER() __sync_synchronize()
+#else
+#define SH2_MEMORY_BARRIER()
+#endif
+#endif
+
+// Quaternions are held as x, y, z, w.
+typedef struct PredictState_s {
+    uint64_t t_us;
+    double q[4];
+    double w[3];     // [rad/s] Angular velocity, sensor frame
+} PredictState_t;
+
+// ------------------------------------------------------------------------
+// Private data
+
+// Published state.  seq is odd while an update is in progress.
+static volatile uint32_t seq;
+static bool valid;
+static PredictState_t state;
+
+// Sensor the held orientation comes from, 0 until the first report
+// (updater only).  Orientation sensors differ in heading reference, so
+// only one is followed until the next reset.
+static uint8_t source;
+
+// Last ARVR report, for estimating its angular velocity (updater only)
+static bool lastArvrValid;
+static PredictState_t lastArvr;
+
+// ------------------------------------------------------------------------
+// Private functions
+
+// r = a * b
+static void qMult(double r[4], const double a[4], const double b[4])
+{
+    r[0] = a[3]*b[0] + a[0]*b[3] + a[1]*b[2] - a[2]*b[1];
+    r[1] = a[3]*b[1] - a[0]*b[2] + a[1]*b[3] + a[2]*b[0];
+    r[2] = a[3]*b[2] + a[0]*b[1] - a[1]*b[0] + a[2]*b[3];
+    r[3] = a[3]*b[3] - a[0]*b[0] - a[1]*b[1] - a[2]*b[2];
+}
+
+static void publish(const PredictState_t *pState)
+{
+    seq++;
+    SH2_MEMORY_BARRIER();
+    state = *pState;
+    valid = true;
+    SH2_MEMORY_BARRIER();
+    seq++;
+}
+
+// Angular velocity that turns the previous ARVR orientation into this one.
+static void arvrRate(PredictState_t *pNew)
+{
+    double conj[4];
+    double d[4];
+    double dt;
+
+    memset(pNew->w, 0, sizeof(pNew->w));
+
+    if (!lastArvrValid || (pNew->t_us <= lastArvr.t_us) ||
+        ((pNew->t_us - lastArvr.t_us) > SH2_PREDICT_MAX_US)) {
+        return;
+    }
+    dt = (pNew->t_us - lastArvr.t_us) * 1.0e-6;
+
+    // d = conj(last) * new, the rotation in the sensor frame
+    conj[0] = -lastArvr.q[0];
+    conj[1] = -lastArvr.q[1];
+    conj[2] = -lastArvr.q[2];
+    conj[3] = lastArvr.q[3];
+    qMult(d, conj, pNew->q);
+    if (d[3] < 0) {
+        // Take the short way round
+        d[0] = -d[0]; d[1] = -d[1]; d[2] = -d[2]; d[3] = -d[3];
+    }
+
+    double s = sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+    double scale = (s > 1.0e-9) ? (2.0 * atan2(s, d[3]) / s / dt) : (2.0 / dt);
+    pNew->w[0] = d[0] * scale;
+    pNew->w[1] = d[1] * scale;
+    pNew->w[2] = d[2] * scale;
+}
+
+// Latch the first orientation sensor seen, and ignore the others.
+static bool fromSource(uint8_t sensorId)
+{
+    if (source == 0) {
+        source = sensorId;
+    }
+
+    return (sensorId == source);
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+void sh2_predictReset(void)
+{
+    seq++;
+    SH2_MEMORY_BARRIER();
+    valid = false;
+    SH2_MEMORY_BARRIER();
+    seq++;
+
+    lastArvrValid = false;
+    source = 0;
+}
+
+void sh2_predictUpdate(const sh2_SensorValue_t *pValue)
+{
+    PredictState_t s;
+
+    s.t_us = pValue->timestamp;
+
+    switch (pValue->sensorId) {
+        case SH2_GYRO_INTEGRATED_RV:
+            sh2_predictGirvCallback(0, &pValue->un.gyroIntegratedRV, pValue->timestamp);
+            return;
+        case SH2_ARVR_STABILIZED_RV:
+            s.q[0] = pValue->un.arvrStabilizedRV.i;
+            s.q[1] = pValue->un.arvrStabilizedRV.j;
+            s.q[2] = pValue->un.arvrStabilizedRV.k;
+            s.q[3] = pValue->un.arvrStabilizedRV.real;
+            break;
+        case SH2_ARVR_STABILIZED_GRV:
+            s.q[0] = pValue->un.arvrStabilizedGRV.i;
+            s.q[1] = pValue->un.arvrStabilizedGRV.j;
+            s.q[2] = pValue->un.arvrStabilizedGRV.k;
+            s.q[3] = pValue->un.arvrStabilizedGRV.real;
+            break;
+        default:
+            return;
+    }
+    if (!fromSource(pValue->sensorId)) {
+        return;
+    }
+
+    arvrRate(&s);
+    lastArvr = s;
+    lastArvrValid = true;
+
+    publish(&s);
+}
+
+void sh2_predictGirvCallback(void *cookie, const struct sh2_GyroIntegratedRV *pGirv,
+                             uint64_t timestamp_uS)
+{
+    (void)cookie;  // unused
+
+    PredictState_t s;
+
+    if (!fromSource(SH2_GYRO_INTEGRATED_RV)) {
+        return;
+    }
+
+    s.t_us = timestamp_uS;
+    s.q[0] = pGirv->i;
+    s.q[1] = pGirv->j;
+    s.q[2] = pGirv->k;
+    s.q[3] = pGirv->real;
+    s.w[0] = pGirv->angVelX;
+    s.w[1] = pGirv->angVelY;
+    s.w[2] = pGirv->angVelZ;
+
+    publish(&s);
+}
+
+int sh2_predictOrientation(uint64_t targetTime_us, sh2_Quaternion_t *pQ)
+{
+    PredictState_t s;
+    uint32_t before;
+    bool haveState;
+
+    if (pQ == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    // Copy the state, retrying if an update overlapped the copy.
+    do {
+        before = seq;
+        SH2_MEMORY_BARRIER();
+        s = state;
+        haveState = valid;
+        SH2_MEMORY_BARRIER();
+    } while ((before & 1) || (before != seq));
+
+    if (!haveState) {
+        return SH2_ERR;
+    }
+
+    // Rotate by the angular velocity over the horizon, in the sensor frame.
+    double dt = 0.0;
+    if (targetTime_us > s.t_us) {
+        uint64_t ahead_us = targetTime_us - s.t_us;
+        if (ahead_us > SH2_PREDICT_MAX_US) {
+            ahead_us = SH2_PREDICT_MAX_US;
+        }
+        dt = ahead_us * 1.0e-6;
+    }
+
+    double rate = sqrt(s.w[0]*s.w[0] + s.w[1]*s.w[1] + s.w[2]*s.w[2]);
+    double half = 0.5 * rate * dt;
+    double d[4];
+    double q[4];
+    if (rate > 1.0e-9) {
+        double k = sin(half) / rate;
+        d[0] = s.w[0] * k;
+        d[1] = s.w[1] * k;
+        d[2] = s.w[2] * k;
+        d[3] = cos(half);
+    }
+    else {
+        d[0] = d[1] = d[2] = 0.0;
+        d[3] = 1.0;
+    }
+    qMult(q, s.q, d);
+
+    double norm = sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+    if (norm <= 0.0) {
+        return SH2_ERR;
+    }
+    pQ->x = q[0] / norm;
+    pQ->y = q[1] / norm;
+    pQ->z = q[2] / norm;
+    pQ->w = q[3] / norm;
+
+    return SH2_OK;
+}
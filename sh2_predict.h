@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Orientation prediction.
+ *
+ * Keeps the latest orientation from Gyro Integrated RV or ARVR-stabilized
+ * rotation vector reports and extrapolates it to a requested host time,
+ * such as the display time of the next frame.  GIRV reports carry their
+ * angular velocity; for ARVR reports it is estimated from the change
+ * between successive reports.
+ *
+ * These sensors do not share a heading reference, so the first of them to
+ * report is followed and the others are ignored until sh2_predictReset().
+ *
+ * Updates come from the thread servicing the hub.  sh2_predictOrientation()
+ * may be called from any other thread (e.g. a render thread) and never
+ * blocks the updater.
+ */
+
+#ifndef SH2_PREDICT_H
+#define SH2_PREDICT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sh2.h"
+#include "sh2_SensorValue.h"
+
+// Longest time the orientation is extrapolated forward
+#ifndef SH2_PREDICT_MAX_US
+#define SH2_PREDICT_MAX_US (100000)
+#endif
+
+// Forget the held orientation and source sensor.  Call on SH2_RESET.
+void sh2_predictReset(void);
+
+// Take a decoded report.  Reports other than GIRV, ARVR-stabilized RV
+// and ARVR-stabilized GRV are ignored.
+void sh2_predictUpdate(const sh2_SensorValue_t *pValue);
+
+// A GIRV fast path callback (see sh2_setGirvCallback) feeding the predictor.
+void sh2_predictGirvCallback(void *cookie, const struct sh2_GyroIntegratedRV *pGirv,
+                             uint64_t timestamp_uS);
+
+// Orientation at targetTime_us, on the host clock used for sensor event
+// timestamps.  Times before the latest report return that report; times
+// more than SH2_PREDICT_MAX_US after it are limited to that horizon.
+// Returns SH2_ERR if no orientation has been received.
+int sh2_predictOrientation(uint64_t targetTime_us, sh2_Quaternion_t *pQ);
+
+#endif
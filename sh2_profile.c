@@ -0,0 +1,434 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Declarative sensor hub profiles.
+ */
+
+#include "sh2_profile.h"
+#include "sh2_err.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ------------------------------------------------------------------------
+// Private functions
+
+// Next whitespace separated token on the line.  Returns its length, 0 at end of line.
+static unsigned nextToken(const char **pp, const char **pToken)
+{
+    const char *p = *pp;
+
+    while ((*p == ' ') || (*p == '\t') || (*p == '\r')) {
+        p++;
+    }
+    *pToken = p;
+    while ((*p != 0) && (*p != '\n') && !isspace((unsigned char)*p)) {
+        p++;
+    }
+    *pp = p;
+
+    return p - *pToken;
+}
+
+static bool tokenIs(const char *token, unsigned len, const char *word)
+{
+    return (strlen(word) == len) && (strncmp(token, word, len) == 0);
+}
+
+static bool parseU32(const char *token, unsigned len, uint32_t *pValue)
+{
+    char *end;
+    unsigned long value;
+
+    // strtoul() would accept a sign and negate the result.
+    if ((len == 0) || (token[0] == '-')) {
+        return false;
+    }
+
+    errno = 0;
+    value = strtoul(token, &end, 0);
+    if ((end != token + len) || (errno == ERANGE) || (value > UINT32_MAX)) {
+        return false;
+    }
+    *pValue = (uint32_t)value;
+
+    return true;
+}
+
+static bool parseDouble(const char *token, unsigned len, double *pValue)
+{
+    char *end;
+
+    if (len == 0) {
+        return false;
+    }
+    *pValue = strtod(token, &end);
+
+    return end == token + len;
+}
+
+// Parse "key=value", accepting key if the token starts with it.
+static bool parseKey(const char *token, unsigned len, const char *key, uint32_t *pValue)
+{
+    unsigned keyLen = strlen(key);
+
+    if ((len <= keyLen + 1) || (strncmp(token, key, keyLen) != 0) || (token[keyLen] != '=')) {
+        return false;
+    }
+
+    return parseU32(token + keyLen + 1, len - keyLen - 1, pValue);
+}
+
+static bool parseSensor(const char *p, sh2_Profile_t *pProfile)
+{
+    const char *token;
+    unsigned len;
+    uint32_t value;
+
+    if (pProfile->sensors >= SH2_PROFILE_MAX_SENSORS) {
+        return false;
+    }
+    sh2_ProfileSensor_t *pSensor = &pProfile->sensor[pProfile->sensors];
+    memset(pSensor, 0, sizeof(sh2_ProfileSensor_t));
+
+    len = nextToken(&p, &token);
+    if (!parseU32(token, len, &value) || (value > SH2_MAX_SENSOR_ID)) {
+        return false;
+    }
+    pSensor->sensorId = (sh2_SensorId_t)value;
+
+    while ((len = nextToken(&p, &token)) != 0) {
+        sh2_SensorConfig_t *pConfig = &pSensor->config;
+
+        if (parseKey(token, len, "interval", &value)) {
+            pConfig->reportInterval_us = value;
+        }
+        else if (parseKey(token, len, "batch", &value)) {
+            pConfig->batchInterval_us = value;
+        }
+        else if (parseKey(token, len, "sensitivity", &value) && (value <= 0xFFFF)) {
+            pConfig->changeSensitivity = (uint16_t)value;
+        }
+        else if (parseKey(token, len, "specific", &value)) {
+            pConfig->sensorSpecific = value;
+        }
+        else if (tokenIs(token, len, "changeOn")) {
+            pConfig->changeSensitivityEnabled = true;
+        }
+        else if (tokenIs(token, len, "relative")) {
+            pConfig->changeSensitivityRelative = true;
+        }
+        else if (tokenIs(token, len, "wake")) {
+            pConfig->wakeupEnabled = true;
+        }
+        else if (tokenIs(token, len, "alwaysOn")) {
+            pConfig->alwaysOnEnabled = true;
+        }
+        else if (tokenIs(token, len, "sniff")) {
+            pConfig->sniffEnabled = true;
+        }
+        else {
+            return false;
+        }
+    }
+
+    pProfile->sensors++;
+
+    return true;
+}
+
+static bool parseFrs(const char *p, sh2_Profile_t *pProfile)
+{
+    const char *token;
+    unsigned len;
+    uint32_t value;
+
+    if (pProfile->frsRecords >= SH2_PROFILE_MAX_FRS) {
+        return false;
+    }
+    sh2_ProfileFrs_t *pFrs = &pProfile->frs[pProfile->frsRecords];
+    memset(pFrs, 0, sizeof(sh2_ProfileFrs_t));
+
+    len = nextToken(&p, &token);
+    if (!parseU32(token, len, &value) || (value > 0xFFFF)) {
+        return false;
+    }
+    pFrs->recordId = (uint16_t)value;
+
+    while ((len = nextToken(&p, &token)) != 0) {
+        if ((pFrs->words >= SH2_PROFILE_MAX_FRS_WORDS) || !parseU32(token, len, &value)) {
+            return false;
+        }
+        pFrs->data[pFrs->words++] = value;
+    }
+
+    pProfile->frsRecords++;
+
+    return true;
+}
+
+static bool parseLine(const char *p, sh2_Profile_t *pProfile)
+{
+    const char *token;
+    unsigned len = nextToken(&p, &token);
+    uint32_t value;
+
+    if ((len == 0) || (token[0] == '#')) {
+        return true;
+    }
+
+    if (tokenIs(token, len, "sensor")) {
+        return parseSensor(p, pProfile);
+    }
+    if (tokenIs(token, len, "frs")) {
+        return parseFrs(p, pProfile);
+    }
+    if (tokenIs(token, len, "cal")) {
+        len = nextToken(&p, &token);
+        if (!parseU32(token, len, &value) || (value > 0xFF)) {
+            return false;
+        }
+        pProfile->hasCalConfig = true;
+        pProfile->calConfig = (uint8_t)value;
+    }
+    else if (tokenIs(token, len, "dcdAutoSave")) {
+        len = nextToken(&p, &token);
+        if (!parseU32(token, len, &value) || (value > 1)) {
+            return false;
+        }
+        pProfile->hasDcdAutoSave = true;
+        pProfile->dcdAutoSave = (value != 0);
+    }
+    else if (tokenIs(token, len, "reorientation")) {
+        double *q[4] = {
+            &pProfile->reorientation.x, &pProfile->reorientation.y,
+            &pProfile->reorientation.z, &pProfile->reorientation.w,
+        };
+        for (unsigned n = 0; n < 4; n++) {
+            len = nextToken(&p, &token);
+            if (!parseDouble(token, len, q[n])) {
+                return false;
+            }
+        }
+        pProfile->hasReorientation = true;
+    }
+    else {
+        return false;
+    }
+
+    // Nothing may follow
+    return nextToken(&p, &token) == 0;
+}
+
+static bool sameConfig(const sh2_SensorConfig_t *a, const sh2_SensorConfig_t *b)
+{
+    return (a->changeSensitivityEnabled == b->changeSensitivityEnabled) &&
+        (a->changeSensitivityRelative == b->changeSensitivityRelative) &&
+        (a->wakeupEnabled == b->wakeupEnabled) &&
+        (a->alwaysOnEnabled == b->alwaysOnEnabled) &&
+        (a->sniffEnabled == b->sniffEnabled) &&
+        (a->changeSensitivity == b->changeSensitivity) &&
+        (a->reportInterval_us == b->reportInterval_us) &&
+        (a->batchInterval_us == b->batchInterval_us) &&
+        (a->sensorSpecific == b->sensorSpecific);
+}
+
+// Compare at the Q14 resolution the hub stores.
+static bool sameQuaternion(const sh2_Quaternion_t *a, const sh2_Quaternion_t *b)
+{
+    return ((int16_t)(a->x * (1 << 14)) == (int16_t)(b->x * (1 << 14))) &&
+        ((int16_t)(a->y * (1 << 14)) == (int16_t)(b->y * (1 << 14))) &&
+        ((int16_t)(a->z * (1 << 14)) == (int16_t)(b->z * (1 << 14))) &&
+        ((int16_t)(a->w * (1 << 14)) == (int16_t)(b->w * (1 << 14)));
+}
+
+static int applySensor(const sh2_ProfileSensor_t *pSensor, sh2_ProfileState_t *pState,
+                       sh2_ProfileStats_t *pStats)
+{
+    uint8_t id = pSensor->sensorId;
+    int rc;
+
+    if (!pState->sensorKnown[id]) {
+        rc = sh2_getSensorConfig(id, &pState->sensor[id]);
+        if (rc != SH2_OK) {
+            return rc;
+        }
+        pState->sensorKnown[id] = true;
+        pStats->reads++;
+    }
+
+    if (sameConfig(&pState->sensor[id], &pSensor->config)) {
+        pStats->skipped++;
+        return SH2_OK;
+    }
+
+    // Set Feature needs no response, so successive sets are pipelined.
+    rc = sh2_setSensorConfig(id, &pSensor->config);
+    pState->sensorKnown[id] = (rc == SH2_OK);
+    if (rc == SH2_OK) {
+        pState->sensor[id] = pSensor->config;
+        pStats->commands++;
+    }
+
+    return rc;
+}
+
+static int applyFrs(const sh2_ProfileFrs_t *pFrs, sh2_ProfileStats_t *pStats)
+{
+    // One spare word shows that the stored record is longer.  getFrs()
+    // may store up to two words past the size it is given.
+    uint32_t current[SH2_PROFILE_MAX_FRS_WORDS + 3];
+    uint16_t words = SH2_PROFILE_MAX_FRS_WORDS + 1;
+    int rc;
+
+    rc = sh2_getFrs(pFrs->recordId, current, &words);
+    pStats->reads++;
+    if ((rc == SH2_OK) && (words == pFrs->words) &&
+        (memcmp(current, pFrs->data, words * sizeof(uint32_t)) == 0)) {
+        pStats->skipped++;
+        return SH2_OK;
+    }
+
+    rc = sh2_setFrs(pFrs->recordId, (uint32_t *)pFrs->data, pFrs->words);
+    if (rc == SH2_OK) {
+        pStats->commands++;
+    }
+
+    return rc;
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+int sh2_profileParse(const char *text, sh2_Profile_t *pProfile, unsigned *pErrLine)
+{
+    unsigned line = 1;
+
+    if ((text == 0) || (pProfile == 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    memset(pProfile, 0, sizeof(sh2_Profile_t));
+
+    while (*text != 0) {
+        if (!parseLine(text, pProfile)) {
+            if (pErrLine != 0) {
+                *pErrLine = line;
+            }
+            return SH2_ERR_BAD_PARAM;
+        }
+
+        // Advance to the next line
+        while ((*text != 0) && (*text != '\n')) {
+            text++;
+        }
+        if (*text == '\n') {
+            text++;
+            line++;
+        }
+    }
+
+    return SH2_OK;
+}
+
+void sh2_profileStateInit(sh2_ProfileState_t *pState)
+{
+    memset(pState, 0, sizeof(sh2_ProfileState_t));
+}
+
+void sh2_profileStateOnReset(sh2_ProfileState_t *pState)
+{
+    memset(pState, 0, sizeof(sh2_ProfileState_t));
+
+    // Every sensor starts disabled.
+    for (unsigned id = 0; id <= SH2_MAX_SENSOR_ID; id++) {
+        pState->sensorKnown[id] = true;
+    }
+}
+
+int sh2_profileApply(const sh2_Profile_t *pProfile, sh2_ProfileState_t *pState,
+                     sh2_ProfileStats_t *pStats)
+{
+    sh2_ProfileStats_t stats;
+    int rc = SH2_OK;
+
+    if ((pProfile == 0) || (pState == 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+    memset(&stats, 0, sizeof(stats));
+
+    // FRS first: some records only take effect once sensors are enabled.
+    for (unsigned n = 0; (rc == SH2_OK) && (n < pProfile->frsRecords); n++) {
+        rc = applyFrs(&pProfile->frs[n], &stats);
+    }
+
+    if ((rc == SH2_OK) && pProfile->hasCalConfig) {
+        if (!pState->calKnown) {
+            rc = sh2_getCalConfig(&pState->calConfig);
+            pState->calKnown = (rc == SH2_OK);
+            stats.reads++;
+        }
+        if ((rc == SH2_OK) && (pState->calConfig == pProfile->calConfig)) {
+            stats.skipped++;
+        }
+        else if (rc == SH2_OK) {
+            rc = sh2_setCalConfig(pProfile->calConfig);
+            pState->calKnown = (rc == SH2_OK);
+            pState->calConfig = pProfile->calConfig;
+            stats.commands++;
+        }
+    }
+
+    if ((rc == SH2_OK) && pProfile->hasDcdAutoSave) {
+        if (pState->dcdKnown && (pState->dcdAutoSave == pProfile->dcdAutoSave)) {
+            stats.skipped++;
+        }
+        else {
+            rc = sh2_setDcdAutoSave(pProfile->dcdAutoSave);
+            pState->dcdKnown = (rc == SH2_OK);
+            pState->dcdAutoSave = pProfile->dcdAutoSave;
+            stats.commands++;
+        }
+    }
+
+    if ((rc == SH2_OK) && pProfile->hasReorientation) {
+        if (pState->reorientationKnown &&
+            sameQuaternion(&pState->reorientation, &pProfile->reorientation)) {
+            stats.skipped++;
+        }
+        else {
+            sh2_Quaternion_t q = pProfile->reorientation;
+            rc = sh2_setReorientation(&q);
+            pState->reorientationKnown = (rc == SH2_OK);
+            pState->reorientation = q;
+            stats.commands++;
+        }
+    }
+
+    for (unsigned n = 0; (rc == SH2_OK) && (n < pProfile->sensors); n++) {
+        rc = applySensor(&pProfile->sensor[n], pState, &stats);
+    }
+
+    if (pStats != 0) {
+        *pStats = stats;
+    }
+
+    return rc;
+}
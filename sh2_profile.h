@@ -0,0 +1,122 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Declarative sensor hub profiles.
+ *
+ * A profile describes the hub state an application wants: sensor
+ * configurations, calibration config, DCD autosave, reorientation and
+ * FRS records.  sh2_profileApply() compares it with what the hub holds
+ * and sends only the commands needed to get there.
+ *
+ * Profiles can be built in code or parsed from text, one item per line:
+ *
+ *   # comment
+ *   sensor 0x05 interval=10000 batch=0 sensitivity=0 specific=0 [changeOn] [relative] [wake] [alwaysOn] [sniff]
+ *   cal 0x07                      (SH2_CAL_... bits)
+ *   dcdAutoSave 1
+ *   reorientation 0 0 0 1         (x y z w)
+ *   frs 0x2d3e 0x00000000 ...     (record id, then 32-bit words)
+ *
+ * Numbers may be decimal or 0x-prefixed hex.
+ */
+
+#ifndef SH2_PROFILE_H
+#define SH2_PROFILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sh2.h"
+
+#ifndef SH2_PROFILE_MAX_SENSORS
+#define SH2_PROFILE_MAX_SENSORS (16)
+#endif
+#ifndef SH2_PROFILE_MAX_FRS
+#define SH2_PROFILE_MAX_FRS (4)
+#endif
+#ifndef SH2_PROFILE_MAX_FRS_WORDS
+#define SH2_PROFILE_MAX_FRS_WORDS (16)
+#endif
+
+typedef struct sh2_ProfileSensor_s {
+    sh2_SensorId_t sensorId;
+    sh2_SensorConfig_t config;
+} sh2_ProfileSensor_t;
+
+typedef struct sh2_ProfileFrs_s {
+    uint16_t recordId;
+    uint16_t words;
+    uint32_t data[SH2_PROFILE_MAX_FRS_WORDS];
+} sh2_ProfileFrs_t;
+
+typedef struct sh2_Profile_s {
+    uint8_t sensors;
+    sh2_ProfileSensor_t sensor[SH2_PROFILE_MAX_SENSORS];
+
+    bool hasCalConfig;
+    uint8_t calConfig;
+
+    bool hasDcdAutoSave;
+    bool dcdAutoSave;
+
+    bool hasReorientation;
+    sh2_Quaternion_t reorientation;
+
+    uint8_t frsRecords;
+    sh2_ProfileFrs_t frs[SH2_PROFILE_MAX_FRS];
+} sh2_Profile_t;
+
+// What the apply engine knows the hub holds.  Settings that the hub
+// can't report (DCD autosave, reorientation) are only known once applied.
+typedef struct sh2_ProfileState_s {
+    bool sensorKnown[SH2_MAX_SENSOR_ID + 1];
+    sh2_SensorConfig_t sensor[SH2_MAX_SENSOR_ID + 1];
+
+    bool calKnown;
+    uint8_t calConfig;
+
+    bool dcdKnown;
+    bool dcdAutoSave;
+
+    bool reorientationKnown;
+    sh2_Quaternion_t reorientation;
+} sh2_ProfileState_t;
+
+typedef struct sh2_ProfileStats_s {
+    uint16_t reads;     // State read back from the hub
+    uint16_t commands;  // Commands sent to change state
+    uint16_t skipped;   // Items already as wanted
+} sh2_ProfileStats_t;
+
+// Parse a text profile.  On a syntax error, returns SH2_ERR_BAD_PARAM and
+// sets *pErrLine (if not NULL) to the offending line number.
+int sh2_profileParse(const char *text, sh2_Profile_t *pProfile, unsigned *pErrLine);
+
+// Forget everything known about the hub.  Use before the first apply.
+void sh2_profileStateInit(sh2_ProfileState_t *pState);
+
+// Record that the hub was reset: all sensors are off and runtime
+// settings are unknown.  Call on SH2_RESET.
+void sh2_profileStateOnReset(sh2_ProfileState_t *pState);
+
+// Bring the hub to the state described by pProfile, sending only the
+// commands needed.  pState is updated with what is now known.
+int sh2_profileApply(const sh2_Profile_t *pProfile, sh2_ProfileState_t *pState,
+                     sh2_ProfileStats_t *pStats);
+
+#endif
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Uniform-grid resampler.
+ */
+
+#include "sh2_resample.h"
+#include "sh2_err.h"
+
+#include <math.h>
+#include <string.h>
+
+// ------------------------------------------------------------------------
+// Private functions
+
+// Index of the report n places older than the newest
+static unsigned histIndex(const sh2_ResampleChannel_t *pChan, unsigned n)
+{
+    return (pChan->head + SH2_RESAMPLE_HISTORY - n) % SH2_RESAMPLE_HISTORY;
+}
+
+static uint64_t newestTime(const sh2_ResampleChannel_t *pChan)
+{
+    return pChan->t_us[pChan->head];
+}
+
+// All four lanes are computed for vectors too, so the loop has no
+// branches and compilers can vectorize it.
+static void lerp(float *out, const float *a, const float *b, float f)
+{
+    for (unsigned n = 0; n < 4; n++) {
+        out[n] = a[n] + (b[n] - a[n]) * f;
+    }
+}
+
+static void slerp(float *out, const float *a, const float *b, float f)
+{
+    float d = a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
+    float sb = 1.0f;
+    float wa;
+    float wb;
+
+    // Take the short way round
+    if (d < 0.0f) {
+        d = -d;
+        sb = -1.0f;
+    }
+
+    if (d > 0.9995f) {
+        // Nearly parallel: linear, then normalize
+        wa = 1.0f - f;
+        wb = f * sb;
+    }
+    else {
+        float theta = acosf(d);
+        float s = sinf(theta);
+        wa = sinf((1.0f - f) * theta) / s;
+        wb = sinf(f * theta) / s * sb;
+    }
+
+    float norm = 0.0f;
+    for (unsigned n = 0; n < 4; n++) {
+        out[n] = wa * a[n] + wb * b[n];
+        norm += out[n] * out[n];
+    }
+    norm = sqrtf(norm);
+    if (norm > 0.0f) {
+        for (unsigned n = 0; n < 4; n++) {
+            out[n] /= norm;
+        }
+    }
+}
+
+// Value of a channel at t_us.  Returns false if its reports don't
+// bracket t_us, leaving the nearest report in out.
+static bool sampleAt(const sh2_ResampleChannel_t *pChan, uint64_t t_us, float *out)
+{
+    unsigned newer = pChan->head;
+
+    if (pChan->count == 0) {
+        memset(out, 0, 4 * sizeof(float));
+        return false;
+    }
+    if (t_us >= newestTime(pChan)) {
+        memcpy(out, pChan->v[newer], 4 * sizeof(float));
+        return t_us == newestTime(pChan);
+    }
+
+    for (unsigned n = 1; n < pChan->count; n++) {
+        unsigned older = histIndex(pChan, n);
+        if (pChan->t_us[older] <= t_us) {
+            float f = (float)(t_us - pChan->t_us[older]) /
+                      (float)(pChan->t_us[newer] - pChan->t_us[older]);
+            if (pChan->axes == 4) {
+                slerp(out, pChan->v[older], pChan->v[newer], f);
+            }
+            else {
+                lerp(out, pChan->v[older], pChan->v[newer], f);
+            }
+            return true;
+        }
+        newer = older;
+    }
+
+    // Older than anything held
+    memcpy(out, pChan->v[newer], 4 * sizeof(float));
+    return false;
+}
+
+// Produce the frames that are now due.
+static void emitFrames(sh2_Resampler_t *pRs)
+{
+    sh2_ResampleFrame_t *pFrame = &pRs->frame;
+
+    // After a long gap, start again from the oldest time still wanted.
+    if ((pRs->newest_us > pRs->next_us + pRs->maxLatency_us + pRs->period_us)) {
+        uint64_t from_us = pRs->newest_us - pRs->maxLatency_us;
+        uint64_t skip = (from_us - pRs->next_us) / pRs->period_us;
+        pRs->next_us += skip * pRs->period_us;
+        pRs->stats.skippedFrames += (uint32_t)skip;
+    }
+
+    while (pRs->newest_us >= pRs->next_us) {
+        bool ready = true;
+        for (unsigned c = 0; c < pRs->channels; c++) {
+            if ((pRs->chan[c].count == 0) || (newestTime(&pRs->chan[c]) < pRs->next_us)) {
+                ready = false;
+            }
+        }
+        if (!ready && (pRs->newest_us < pRs->next_us + pRs->maxLatency_us)) {
+            // Wait for the slower sensors
+            return;
+        }
+
+        pFrame->t_us = pRs->next_us;
+        pFrame->valid = 0;
+        for (unsigned c = 0; c < pRs->channels; c++) {
+            if (sampleAt(&pRs->chan[c], pRs->next_us, pFrame->value[c])) {
+                pFrame->valid |= (uint8_t)(1 << c);
+            }
+        }
+
+        pRs->stats.frames++;
+        if (!ready) {
+            pRs->stats.partialFrames++;
+        }
+        pRs->next_us += pRs->period_us;
+
+        if (pRs->callback != 0) {
+            pRs->callback(pRs->cookie, pFrame);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+int sh2_resampleInit(sh2_Resampler_t *pRs, uint32_t period_us, uint32_t maxLatency_us,
+                     sh2_ResampleCallback_t *callback, void *cookie)
+{
+    if ((pRs == 0) || (period_us == 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    memset(pRs, 0, sizeof(sh2_Resampler_t));
+    pRs->period_us = period_us;
+    pRs->maxLatency_us = maxLatency_us;
+    pRs->callback = callback;
+    pRs->cookie = cookie;
+
+    return SH2_OK;
+}
+
+int sh2_resampleAddChannel(sh2_Resampler_t *pRs, sh2_SensorId_t sensorId)
+{
+    sh2_SensorValue_t probe;
+    float axes[4];
+
+    if (pRs->channels >= SH2_RESAMPLE_MAX_CHANNELS) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    // Only vectors and quaternions can be interpolated.
+    memset(&probe, 0, sizeof(probe));
+    probe.sensorId = sensorId;
+    int n = sh2_getAxes(&probe, axes);
+    if (n == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    sh2_ResampleChannel_t *pChan = &pRs->chan[pRs->channels];
+    memset(pChan, 0, sizeof(sh2_ResampleChannel_t));
+    pChan->sensorId = sensorId;
+    pChan->axes = (uint8_t)n;
+
+    return pRs->channels++;
+}
+
+void sh2_resampleReset(sh2_Resampler_t *pRs)
+{
+    for (unsigned c = 0; c < pRs->channels; c++) {
+        pRs->chan[c].count = 0;
+        pRs->chan[c].head = 0;
+    }
+    pRs->started = false;
+    pRs->newest_us = 0;
+}
+
+void sh2_resampleInput(sh2_Resampler_t *pRs, const sh2_SensorValue_t *pValue)
+{
+    sh2_ResampleChannel_t *pChan = 0;
+
+    for (unsigned c = 0; c < pRs->channels; c++) {
+        if (pRs->chan[c].sensorId == pValue->sensorId) {
+            pChan = &pRs->chan[c];
+            break;
+        }
+    }
+    if (pChan == 0) {
+        return;
+    }
+
+    if ((pChan->count != 0) && (pValue->timestamp <= newestTime(pChan))) {
+        pRs->stats.lateReports++;
+        return;
+    }
+
+    // Store the report
+    if (pChan->count != 0) {
+        pChan->head = (pChan->head + 1) % SH2_RESAMPLE_HISTORY;
+    }
+    if (pChan->count < SH2_RESAMPLE_HISTORY) {
+        pChan->count++;
+    }
+    pChan->t_us[pChan->head] = pValue->timestamp;
+    pChan->v[pChan->head][3] = 0.0f;
+    sh2_getAxes(pValue, pChan->v[pChan->head]);
+
+    if (!pRs->started) {
+        // First grid time at or after the first report
+        pRs->next_us = ((pValue->timestamp + pRs->period_us - 1) / pRs->period_us) * pRs->period_us;
+        pRs->started = true;
+    }
+    if (pValue->timestamp > pRs->newest_us) {
+        pRs->newest_us = pValue->timestamp;
+    }
+
+    emitFrames(pRs);
+}
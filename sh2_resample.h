@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Uniform-grid resampler.
+ *
+ * Takes decoded reports from several sensors, each at its own rate and
+ * phase, and produces frames at a fixed period with every sensor's
+ * value at the frame time.  Vectors are interpolated linearly and
+ * quaternions by SLERP.
+ *
+ * A frame is produced once every sensor has reported past its time.  If
+ * a sensor falls more than maxLatency_us behind the newest report, the
+ * frame is produced without it (its bit in valid is clear).
+ *
+ * Grid times are multiples of the period on the sensor event clock, so
+ * resamplers with the same period line up with each other.
+ */
+
+#ifndef SH2_RESAMPLE_H
+#define SH2_RESAMPLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sh2.h"
+#include "sh2_SensorValue.h"
+
+#ifndef SH2_RESAMPLE_MAX_CHANNELS
+#define SH2_RESAMPLE_MAX_CHANNELS (4)
+#endif
+
+#if SH2_RESAMPLE_MAX_CHANNELS > 8
+#error "SH2_RESAMPLE_MAX_CHANNELS is limited to the 8 bits of sh2_ResampleFrame_t.valid"
+#endif
+
+// Reports held per sensor.  Must cover maxLatency_us at the sensor's rate.
+#ifndef SH2_RESAMPLE_HISTORY
+#define SH2_RESAMPLE_HISTORY (8)
+#endif
+
+typedef struct sh2_ResampleFrame_s {
+    uint64_t t_us;
+    uint8_t valid;      // Bit per channel holding a value at t_us
+    float value[SH2_RESAMPLE_MAX_CHANNELS][4];  // x, y, z or i, j, k, real
+} sh2_ResampleFrame_t;
+
+typedef void (sh2_ResampleCallback_t)(void *cookie, const sh2_ResampleFrame_t *pFrame);
+
+typedef struct sh2_ResampleChannel_s {
+    uint8_t sensorId;
+    uint8_t axes;       // 3 for vectors, 4 for quaternions
+    uint8_t head;       // Newest report
+    uint8_t count;
+    uint64_t t_us[SH2_RESAMPLE_HISTORY];
+    float v[SH2_RESAMPLE_HISTORY][4];
+} sh2_ResampleChannel_t;
+
+typedef struct sh2_ResampleStats_s {
+    uint32_t frames;
+    uint32_t partialFrames;   // Produced with a channel missing
+    uint32_t skippedFrames;   // Grid times passed over after a gap
+    uint32_t lateReports;     // Older than the channel's newest, dropped
+} sh2_ResampleStats_t;
+
+typedef struct sh2_Resampler_s {
+    uint32_t period_us;
+    uint32_t maxLatency_us;
+    sh2_ResampleCallback_t *callback;
+    void *cookie;
+
+    uint8_t channels;
+    sh2_ResampleChannel_t chan[SH2_RESAMPLE_MAX_CHANNELS];
+
+    bool started;
+    uint64_t next_us;         // Time of the next frame
+    uint64_t newest_us;       // Newest report on any channel
+    sh2_ResampleFrame_t frame;
+
+    sh2_ResampleStats_t stats;
+} sh2_Resampler_t;
+
+// Set up a resampler producing a frame every period_us.
+int sh2_resampleInit(sh2_Resampler_t *pRs, uint32_t period_us, uint32_t maxLatency_us,
+                     sh2_ResampleCallback_t *callback, void *cookie);
+
+// Add a vector or quaternion sensor (see sh2_getAxes).  Returns its
+// channel number, the bit in sh2_ResampleFrame_t.valid, or a negative
+// error code.
+int sh2_resampleAddChannel(sh2_Resampler_t *pRs, sh2_SensorId_t sensorId);
+
+// Drop held reports and restart the grid, e.g. after SH2_RESET.
+void sh2_resampleReset(sh2_Resampler_t *pRs);
+
+// Take one decoded report.  Frames that become complete are passed to
+// the callback before returning.  Reports for other sensors are ignored.
+// There is no batch entry point: feed a batch flush one report at a time,
+// in time order.
+void sh2_resampleInput(sh2_Resampler_t *pRs, const sh2_SensorValue_t *pValue);
+
+#endif
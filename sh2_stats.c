@@ -0,0 +1,215 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Online sensor statistics.
+ */
+
+#include "sh2_stats.h"
+#include "sh2_err.h"
+
+#include <math.h>
+#include <string.h>
+
+// ------------------------------------------------------------------------
+// Private functions
+
+static void addInterval(sh2_SensorStats_t *pStats, uint64_t t_us)
+{
+    if ((pStats->samples != 0) && (t_us > pStats->last_us)) {
+        uint64_t dt = t_us - pStats->last_us;
+        uint32_t dt_us = (dt > UINT32_MAX) ? UINT32_MAX : (uint32_t)dt;
+
+        pStats->intervals++;
+        double delta = dt_us - pStats->intervalMean_us;
+        pStats->intervalMean_us += delta / pStats->intervals;
+        pStats->intervalM2 += delta * (dt_us - pStats->intervalMean_us);
+
+        if ((pStats->intervals == 1) || (dt_us < pStats->intervalMin_us)) {
+            pStats->intervalMin_us = dt_us;
+        }
+        if (dt_us > pStats->intervalMax_us) {
+            pStats->intervalMax_us = dt_us;
+        }
+    }
+    pStats->last_us = t_us;
+}
+
+// Update one axis with report number n (counting from 1).
+static void addValue(sh2_AxisStats_t *pAxis, uint32_t n, uint16_t head, float x)
+{
+    // Welford
+    double delta = x - pAxis->mean;
+    pAxis->mean += delta / n;
+    pAxis->m2 += delta * (x - pAxis->mean);
+
+    if ((n == 1) || (x < pAxis->min)) {
+        pAxis->min = x;
+    }
+    if ((n == 1) || (x > pAxis->max)) {
+        pAxis->max = x;
+    }
+
+    // Running sum, so the mean over any cluster is a difference of sums.
+    uint16_t prev = (head + SH2_STATS_HISTORY - 1) % SH2_STATS_HISTORY;
+    pAxis->sum[head] = ((n == 1) ? 0.0 : pAxis->sum[prev]) + x;
+
+    // Overlapping Allan variance: for cluster size m, the second
+    // difference of sums m apart over the latest 2m reports.
+    for (unsigned level = 0; level < SH2_STATS_ADEV_LEVELS; level++) {
+        uint32_t m = 1u << level;
+        if (n <= 2 * m) {
+            break;
+        }
+        double s0 = pAxis->sum[head];
+        double s1 = pAxis->sum[(head + SH2_STATS_HISTORY - m) % SH2_STATS_HISTORY];
+        double s2 = pAxis->sum[(head + SH2_STATS_HISTORY - 2 * m) % SH2_STATS_HISTORY];
+        double d = s0 - 2.0 * s1 + s2;
+
+        pAxis->adevSum[level] += d * d;
+        pAxis->adevCount[level]++;
+    }
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+int sh2_statsInit(sh2_SensorStats_t *pStats, sh2_SensorId_t sensorId)
+{
+    sh2_SensorValue_t probe;
+    float axes[4];
+
+    if (pStats == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    // Only vectors and quaternions have axes to analyze.
+    memset(&probe, 0, sizeof(probe));
+    probe.sensorId = sensorId;
+    int n = sh2_getAxes(&probe, axes);
+    if (n == 0) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    memset(pStats, 0, sizeof(sh2_SensorStats_t));
+    pStats->sensorId = sensorId;
+    pStats->axes = (uint8_t)n;
+
+    return SH2_OK;
+}
+
+void sh2_statsInput(sh2_SensorStats_t *pStats, const sh2_SensorValue_t *pValue)
+{
+    float x[4];
+
+    if (pValue->sensorId != pStats->sensorId) {
+        return;
+    }
+    sh2_getAxes(pValue, x);
+
+    addInterval(pStats, pValue->timestamp);
+
+    pStats->samples++;
+    if (pStats->samples != 1) {
+        pStats->head = (pStats->head + 1) % SH2_STATS_HISTORY;
+    }
+    for (unsigned a = 0; a < pStats->axes; a++) {
+        addValue(&pStats->axis[a], pStats->samples, pStats->head, x[a]);
+    }
+}
+
+int sh2_statsGet(const sh2_SensorStats_t *pStats, sh2_StatsResult_t *pResult)
+{
+    if ((pStats == 0) || (pResult == 0)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    memset(pResult, 0, sizeof(sh2_StatsResult_t));
+    pResult->samples = pStats->samples;
+    pResult->axes = pStats->axes;
+
+    for (unsigned a = 0; a < pStats->axes; a++) {
+        const sh2_AxisStats_t *pAxis = &pStats->axis[a];
+
+        pResult->mean[a] = (float)pAxis->mean;
+        pResult->min[a] = pAxis->min;
+        pResult->max[a] = pAxis->max;
+        if (pStats->samples > 1) {
+            pResult->stdDev[a] = (float)sqrt(pAxis->m2 / (pStats->samples - 1));
+        }
+    }
+
+    pResult->intervalMean_us = (float)pStats->intervalMean_us;
+    pResult->intervalMin_us = pStats->intervalMin_us;
+    pResult->intervalMax_us = pStats->intervalMax_us;
+    if (pStats->intervals > 1) {
+        pResult->intervalJitter_us = (float)sqrt(pStats->intervalM2 / (pStats->intervals - 1));
+    }
+
+    // AVAR(m) = sum of squared second differences / (2 m^2 count)
+    for (unsigned level = 0; level < SH2_STATS_ADEV_LEVELS; level++) {
+        uint32_t m = 1u << level;
+        if (pStats->axis[0].adevCount[level] == 0) {
+            break;
+        }
+        pResult->tau_s[level] = (float)(m * pStats->intervalMean_us * 1.0e-6);
+        for (unsigned a = 0; a < pStats->axes; a++) {
+            const sh2_AxisStats_t *pAxis = &pStats->axis[a];
+            double avar = pAxis->adevSum[level] / (2.0 * m * m * pAxis->adevCount[level]);
+            pResult->adev[a][level] = (float)sqrt(avar);
+        }
+        pResult->adevLevels = level + 1;
+    }
+
+    return SH2_OK;
+}
+
+void sh2_statsSetInit(sh2_StatsSet_t *pSet)
+{
+    memset(pSet, 0, sizeof(sh2_StatsSet_t));
+}
+
+int sh2_statsSetAdd(sh2_StatsSet_t *pSet, sh2_SensorId_t sensorId)
+{
+    if (pSet->sensors >= SH2_STATS_MAX_SENSORS) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    int rc = sh2_statsInit(&pSet->sensor[pSet->sensors], sensorId);
+    if (rc == SH2_OK) {
+        pSet->sensors++;
+    }
+
+    return rc;
+}
+
+void sh2_statsSensorCallback(void *cookie, sh2_SensorEvent_t *pEvent)
+{
+    sh2_StatsSet_t *pSet = (sh2_StatsSet_t *)cookie;
+    sh2_SensorValue_t value;
+
+    for (unsigned n = 0; n < pSet->sensors; n++) {
+        if (pSet->sensor[n].sensorId == pEvent->reportId) {
+            if (sh2_decodeSensorEvent(&value, pEvent) != SH2_OK) {
+                pSet->decodeErrors++;
+                return;
+            }
+            sh2_statsInput(&pSet->sensor[n], &value);
+            return;
+        }
+    }
+}
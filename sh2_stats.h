@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Online sensor statistics.
+ *
+ * Keeps running figures for vector and quaternion sensors in fixed
+ * memory, at constant cost per report:
+ *   - mean, standard deviation, min and max per axis (Welford)
+ *   - report interval mean, jitter (standard deviation), min and max
+ *   - overlapping Allan deviation per axis at cluster times of 1, 2, 4,
+ *     ... 2^(SH2_STATS_ADEV_LEVELS-1) report intervals
+ *
+ * Feed decoded reports with sh2_statsInput(), or register
+ * sh2_statsSensorCallback() with sh2_setSensorCallback() to gather
+ * figures for a set of sensors directly from dispatch.
+ */
+
+#ifndef SH2_STATS_H
+#define SH2_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sh2.h"
+#include "sh2_SensorValue.h"
+
+// Allan deviation cluster sizes: 1, 2, 4 ... 2^(levels-1) reports.
+// History per axis is 2^levels + 1 values.
+#ifndef SH2_STATS_ADEV_LEVELS
+#define SH2_STATS_ADEV_LEVELS (8)
+#endif
+#define SH2_STATS_HISTORY ((1 << SH2_STATS_ADEV_LEVELS) + 1)
+
+// Sensors in an sh2_StatsSet_t
+#ifndef SH2_STATS_MAX_SENSORS
+#define SH2_STATS_MAX_SENSORS (4)
+#endif
+
+typedef struct sh2_AxisStats_s {
+    double mean;
+    double m2;                  // Sum of squared deviations
+    float min;
+    float max;
+    double adevSum[SH2_STATS_ADEV_LEVELS];
+    uint32_t adevCount[SH2_STATS_ADEV_LEVELS];
+    double sum[SH2_STATS_HISTORY];  // Running sum of the axis, by report
+} sh2_AxisStats_t;
+
+typedef struct sh2_SensorStats_s {
+    uint8_t sensorId;
+    uint8_t axes;
+    uint32_t samples;
+    uint16_t head;              // History slot of the latest report
+    sh2_AxisStats_t axis[4];
+
+    uint64_t last_us;
+    uint32_t intervals;
+    double intervalMean_us;
+    double intervalM2;
+    uint32_t intervalMin_us;
+    uint32_t intervalMax_us;
+} sh2_SensorStats_t;
+
+typedef struct sh2_StatsResult_s {
+    uint32_t samples;
+    uint8_t axes;
+    float mean[4];
+    float stdDev[4];
+    float min[4];
+    float max[4];
+
+    float intervalMean_us;
+    float intervalJitter_us;    // Standard deviation of the interval
+    uint32_t intervalMin_us;
+    uint32_t intervalMax_us;
+
+    uint8_t adevLevels;         // Levels with enough reports to estimate
+    float tau_s[SH2_STATS_ADEV_LEVELS];
+    float adev[4][SH2_STATS_ADEV_LEVELS];
+} sh2_StatsResult_t;
+
+typedef struct sh2_StatsSet_s {
+    uint8_t sensors;
+    sh2_SensorStats_t sensor[SH2_STATS_MAX_SENSORS];
+    uint32_t decodeErrors;
+} sh2_StatsSet_t;
+
+// Start gathering statistics for one vector or quaternion sensor.
+int sh2_statsInit(sh2_SensorStats_t *pStats, sh2_SensorId_t sensorId);
+
+// Add one report.  Reports for other sensors are ignored.
+void sh2_statsInput(sh2_SensorStats_t *pStats, const sh2_SensorValue_t *pValue);
+
+// Compute the figures gathered so far.
+int sh2_statsGet(const sh2_SensorStats_t *pStats, sh2_StatsResult_t *pResult);
+
+// Set of sensors fed from the sensor callback.
+void sh2_statsSetInit(sh2_StatsSet_t *pSet);
+int sh2_statsSetAdd(sh2_StatsSet_t *pSet, sh2_SensorId_t sensorId);
+
+// An sh2_SensorCallback_t.  cookie is the sh2_StatsSet_t.
+void sh2_statsSensorCallback(void *cookie, sh2_SensorEvent_t *pEvent);
+
+#endif
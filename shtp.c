@@ -31,11 +31,23 @@
 #define SHTP_MAX_CHANS (8)  // Max channels per SHTP device
 #define SHTP_HDR_LEN (4)
 
+// Consecutive read errors after which a transmit waiting for the HAL
+// gives up, rather than waiting on a HAL that has failed.
+#ifndef SHTP_TX_MAX_READ_ERRORS
+#define SHTP_TX_MAX_READ_ERRORS (8)
+#endif
+
 typedef struct shtp_Channel_s {
     uint8_t nextOutSeq;
     uint8_t nextInSeq;
     shtp_Callback_t *callback;
     void *cookie;
+
+    // Streaming delivery
+    shtp_StreamMode_t streamMode;
+    shtp_ReportLen_t *reportLen;
+    shtp_StreamCallback_t *streamCallback;
+    void *streamCookie;
 } shtp_Channel_t;
 
 // Per-instance data for SHTP
@@ -49,15 +61,33 @@ typedef struct shtp_s {
     void * eventCookie;
 
     // Transmit support
-    uint8_t outTransfer[SH2_HAL_MAX_TRANSFER_OUT];
+    uint8_t *outTransfer;
+    uint16_t outTransferLen;
 
     // Receive support
     uint16_t inRemaining;
     uint8_t  inChan;
-    uint8_t  inPayload[SH2_HAL_MAX_PAYLOAD_IN];
+    uint8_t *inPayload;
+    uint16_t inPayloadLen;
     uint16_t inCursor;
-    uint32_t inTimestamp;
-    uint8_t inTransfer[SH2_HAL_MAX_TRANSFER_IN];
+    uint64_t inTimestamp;
+    uint32_t lastT_us;      // For extending 32-bit HAL timestamps
+    uint32_t rollovers;
+    uint8_t *inTransfer;
+    uint16_t inTransferLen;
+
+    // Payload being streamed rather than reassembled
+    bool inStreaming;
+    bool streamFirst;       // Next piece delivered is the first
+    bool streamSkip;        // Rest of the payload is being dropped
+    uint8_t carryLen;       // Bytes of a split report held back
+    uint8_t carry[SHTP_STREAM_CARRY_LEN];
+
+#if SHTP_BUILTIN_BUFFERS
+    uint8_t builtinOutTransfer[SHTP_OUT_TRANSFER_LEN];
+    uint8_t builtinInPayload[SHTP_IN_PAYLOAD_LEN];
+    uint8_t builtinInTransfer[SHTP_IN_TRANSFER_LEN];
+#endif
 
     // SHTP Channels
     shtp_Channel_t      chan[SHTP_MAX_CHANS];
@@ -67,11 +97,16 @@ typedef struct shtp_s {
     uint32_t rxShortFragments;
     uint32_t rxTooLargePayloads;
     uint32_t rxInterruptedPayloads;
+    uint32_t rxStreamedPayloads;
+    uint32_t rxStreamDrops;
     
     uint32_t badTxChan;
     uint32_t txDiscards;
     uint32_t txTooLargePayloads;
 
+    // HAL reads and writes failed since the last one that succeeded
+    uint32_t halFailures;
+
 } shtp_t;
 
 
@@ -109,6 +144,50 @@ static shtp_t *getInstance(void)
     return 0;
 }
 
+// Point the instance at caller buffers or its own.  Returns false if a
+// buffer is missing or too small.
+static bool setBuffers(shtp_t *pShtp, const shtp_Buffers_t *pBuffers)
+{
+    shtp_Buffers_t b;
+
+    if (pBuffers != 0) {
+        b = *pBuffers;
+    }
+    else {
+        memset(&b, 0, sizeof(b));
+    }
+
+#if SHTP_BUILTIN_BUFFERS
+    if (b.pInTransfer == 0) {
+        b.pInTransfer = pShtp->builtinInTransfer;
+        b.inTransferLen = SHTP_IN_TRANSFER_LEN;
+    }
+    if (b.pInPayload == 0) {
+        b.pInPayload = pShtp->builtinInPayload;
+        b.inPayloadLen = SHTP_IN_PAYLOAD_LEN;
+    }
+    if (b.pOutTransfer == 0) {
+        b.pOutTransfer = pShtp->builtinOutTransfer;
+        b.outTransferLen = SHTP_OUT_TRANSFER_LEN;
+    }
+#endif
+
+    if ((b.pInTransfer == 0) || (b.inTransferLen < SHTP_HDR_LEN) ||
+        (b.pInPayload == 0) ||
+        (b.pOutTransfer == 0) || (b.outTransferLen <= SHTP_HDR_LEN)) {
+        return false;
+    }
+
+    pShtp->inTransfer = b.pInTransfer;
+    pShtp->inTransferLen = b.inTransferLen;
+    pShtp->inPayload = b.pInPayload;
+    pShtp->inPayloadLen = b.inPayloadLen;
+    pShtp->outTransfer = b.pOutTransfer;
+    pShtp->outTransferLen = b.outTransferLen;
+
+    return true;
+}
+
 
 static inline uint16_t min_u16(uint16_t a, uint16_t b)
 {
@@ -135,7 +214,7 @@ static int txProcess(shtp_t *pShtp, uint8_t chan, const uint8_t* pData, uint32_t
     remaining = len;
     while (remaining > 0) {
         // How much data (not header) can we send in next transfer
-        transferLen = min_u16(remaining, SH2_HAL_MAX_TRANSFER_OUT-SHTP_HDR_LEN);
+        transferLen = min_u16(remaining, pShtp->outTransferLen-SHTP_HDR_LEN);
         
         // Length field will be transferLen + SHTP_HDR_LEN
         lenField = transferLen + SHTP_HDR_LEN;
@@ -158,16 +237,22 @@ static int txProcess(shtp_t *pShtp, uint8_t chan, const uint8_t* pData, uint32_t
         status = pShtp->pHal->write(pShtp->pHal, pShtp->outTransfer, lenField);
         while (status == 0)
         {
-            shtp_service(pShtp);
+            if ((shtp_service(pShtp) < 0) &&
+                (pShtp->halFailures >= SHTP_TX_MAX_READ_ERRORS)) {
+                status = SH2_ERR_IO;
+                break;
+            }
             status = pShtp->pHal->write(pShtp->pHal, pShtp->outTransfer, lenField);
         }
         
         if (status < 0)
         {
             // Error, throw away this cargo
+            pShtp->halFailures++;
             pShtp->txDiscards++;
             return status;
         }
+        pShtp->halFailures = 0;
 
         // For the rest of this transmission, packets are continuations.
         continuation = true;
@@ -176,7 +261,78 @@ static int txProcess(shtp_t *pShtp, uint8_t chan, const uint8_t* pData, uint32_t
     return SH2_OK;
 }
 
-static void rxAssemble(shtp_t *pShtp, uint8_t *in, uint16_t len, uint32_t t_us)
+// Pass whole reports to the channel's stream listener.
+static void streamDeliver(shtp_t *pShtp, uint8_t *data, uint16_t len)
+{
+    shtp_Channel_t *pChan = &pShtp->chan[pShtp->inChan];
+
+    if (len == 0) {
+        return;
+    }
+
+    pChan->streamCallback(pChan->streamCookie, data, len,
+                          pShtp->inTimestamp, pShtp->streamFirst);
+    pShtp->streamFirst = false;
+}
+
+// Deliver the whole reports in one fragment of a streamed payload and
+// hold back any report that continues into the next fragment.
+static void streamFragment(shtp_t *pShtp, uint8_t *data, uint16_t len)
+{
+    shtp_Channel_t *pChan = &pShtp->chan[pShtp->inChan];
+    uint16_t cursor = 0;
+    uint8_t reportLen;
+
+    if (pShtp->streamSkip) {
+        return;
+    }
+
+    // Complete a report split across fragments
+    if (pShtp->carryLen != 0) {
+        reportLen = pChan->reportLen(pChan->streamCookie, pShtp->carry);
+        uint16_t take = min_u16(reportLen - pShtp->carryLen, len);
+
+        memcpy(pShtp->carry + pShtp->carryLen, data, take);
+        pShtp->carryLen += take;
+        cursor = take;
+        if (pShtp->carryLen < reportLen) {
+            return;
+        }
+        streamDeliver(pShtp, pShtp->carry, pShtp->carryLen);
+        pShtp->carryLen = 0;
+    }
+
+    // Whole reports are delivered in place
+    uint16_t start = cursor;
+    while (cursor < len) {
+        reportLen = pChan->reportLen(pChan->streamCookie, data + cursor);
+        if (reportLen == 0) {
+            // Can't find the next report, so drop the rest of the payload.
+            streamDeliver(pShtp, data + start, cursor - start);
+            pShtp->streamSkip = true;
+            pShtp->rxStreamDrops++;
+            return;
+        }
+        if (cursor + reportLen > len) {
+            if (reportLen > SHTP_STREAM_CARRY_LEN) {
+                // Too long to hold back
+                streamDeliver(pShtp, data + start, cursor - start);
+                pShtp->streamSkip = true;
+                pShtp->rxStreamDrops++;
+                return;
+            }
+            break;
+        }
+        cursor += reportLen;
+    }
+    streamDeliver(pShtp, data + start, cursor - start);
+
+    // Hold back the start of a split report
+    pShtp->carryLen = len - cursor;
+    memcpy(pShtp->carry, data + cursor, pShtp->carryLen);
+}
+
+static void rxAssemble(shtp_t *pShtp, uint8_t *in, uint16_t len, uint64_t t_us)
 {
     uint16_t payloadLen;
     bool continuation;
@@ -238,6 +394,7 @@ static void rxAssemble(shtp_t *pShtp, uint8_t *in, uint16_t len, uint32_t t_us)
             
             // This fragment doesn't fit with previous one, discard earlier data
             pShtp->inRemaining = 0;
+            pShtp->inStreaming = false;
 
             pShtp->rxInterruptedPayloads++;
             if (pShtp->eventCallback) {
@@ -250,7 +407,19 @@ static void rxAssemble(shtp_t *pShtp, uint8_t *in, uint16_t len, uint32_t t_us)
     pShtp->chan[chan].nextInSeq = seq + 1;
 
     if (pShtp->inRemaining == 0) {
-        if (payloadLen > sizeof(pShtp->inPayload)) {
+        pShtp->inStreaming = false;
+        if ((pShtp->chan[chan].streamMode == SHTP_STREAM_ALWAYS) ||
+            ((pShtp->chan[chan].streamMode == SHTP_STREAM_OVERSIZE) &&
+             (payloadLen > pShtp->inPayloadLen))) {
+            // Stream it, because it's too large to reassemble or the
+            // listener wants each report without waiting for the rest.
+            pShtp->inStreaming = true;
+            pShtp->streamFirst = true;
+            pShtp->streamSkip = false;
+            pShtp->carryLen = 0;
+            pShtp->rxStreamedPayloads++;
+        }
+        else if (payloadLen > pShtp->inPayloadLen) {
             // Error: This payload won't fit! Discard it.
             pShtp->rxTooLargePayloads++;
             
@@ -276,6 +445,18 @@ static void rxAssemble(shtp_t *pShtp, uint8_t *in, uint16_t len, uint32_t t_us)
         // Only use the valid portion of the transfer
         len = payloadLen;
     }
+
+    if (pShtp->inStreaming) {
+        pShtp->inRemaining = payloadLen - len;
+        streamFragment(pShtp, in+SHTP_HDR_LEN, len-SHTP_HDR_LEN);
+        if ((pShtp->inRemaining == 0) && (pShtp->carryLen != 0)) {
+            // Payload ended partway through a report
+            pShtp->carryLen = 0;
+            pShtp->rxStreamDrops++;
+        }
+        return;
+    }
+
     memcpy(pShtp->inPayload + pShtp->inCursor, in+SHTP_HDR_LEN, len-SHTP_HDR_LEN);
     pShtp->inCursor += len-SHTP_HDR_LEN;
     pShtp->inRemaining = payloadLen - len;
@@ -298,6 +479,12 @@ static void rxAssemble(shtp_t *pShtp, uint8_t *in, uint16_t len, uint32_t t_us)
 // Takes HAL pointer, returns shtp ID for use in future calls.
 // HAL will be opened by this call.
 void *shtp_open(sh2_Hal_t *pHal)
+{
+    return shtp_openBuffers(pHal, 0);
+}
+
+// As shtp_open, using caller buffers where given.
+void *shtp_openBuffers(sh2_Hal_t *pHal, const shtp_Buffers_t *pBuffers)
 {
     if (!shtp_initialized) {
         // Perform one-time module initialization
@@ -319,6 +506,10 @@ void *shtp_open(sh2_Hal_t *pHal)
 
     // Clear the SHTP instance as a shortcut to initializing all fields
     memset(pShtp, 0, sizeof(shtp_t));
+
+    if (!setBuffers(pShtp, pBuffers)) {
+        return 0;
+    }
     
     // Open HAL
     int status = pHal->open(pHal);
@@ -332,6 +523,11 @@ void *shtp_open(sh2_Hal_t *pHal)
     return pShtp;
 }
 
+uint32_t shtp_instanceBytes(void)
+{
+    return sizeof(shtp_t);
+}
+
 // Releases resources associated with this SHTP instance.
 // HAL will not be closed.
 void shtp_close(void *pInstance)
@@ -373,6 +569,29 @@ int shtp_listenChan(void *pInstance,
     return SH2_OK;
 }
 
+// Select streaming delivery for a channel
+int shtp_streamChan(void *pInstance, uint8_t channel, shtp_StreamMode_t mode,
+                    shtp_ReportLen_t *reportLen,
+                    shtp_StreamCallback_t *callback, void *cookie)
+{
+    shtp_t *pShtp = (shtp_t *)pInstance;
+
+    // Balk if channel is invalid
+    if ((channel == 0) || (channel >= SHTP_MAX_CHANS)) {
+        return SH2_ERR_BAD_PARAM;
+    }
+    if ((mode != SHTP_STREAM_OFF) && ((reportLen == 0) || (callback == 0))) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    pShtp->chan[channel].streamMode = mode;
+    pShtp->chan[channel].reportLen = reportLen;
+    pShtp->chan[channel].streamCallback = callback;
+    pShtp->chan[channel].streamCookie = cookie;
+
+    return SH2_OK;
+}
+
 // Send an SHTP payload on a particular channel
 int shtp_send(void *pInstance,
               uint8_t channel,
@@ -393,13 +612,44 @@ int shtp_send(void *pInstance,
 }
 
 // Check for received data and process it.
-void shtp_service(void *pInstance)
+int shtp_service(void *pInstance)
 {
     shtp_t *pShtp = (shtp_t *)pInstance;
-    uint32_t t_us = 0;
-    
-    int len = pShtp->pHal->read(pShtp->pHal, pShtp->inTransfer, sizeof(pShtp->inTransfer), &t_us);
+    uint64_t t_us = 0;
+    int len;
+
+    if (pShtp->pHal->readTs != 0) {
+        len = pShtp->pHal->readTs(pShtp->pHal, pShtp->inTransfer, pShtp->inTransferLen, &t_us);
+    }
+    else {
+        uint32_t t32_us = 0;
+        len = pShtp->pHal->read(pShtp->pHal, pShtp->inTransfer, pShtp->inTransferLen, &t32_us);
+        if (len > 0) {
+            // Count times the HAL timestamp rolled over to produce upper bits
+            if (t32_us < pShtp->lastT_us) {
+                pShtp->rollovers++;
+            }
+            pShtp->lastT_us = t32_us;
+            t_us = ((uint64_t)pShtp->rollovers << 32) + t32_us;
+        }
+    }
+    if (len < 0) {
+        pShtp->halFailures++;
+    }
+    else {
+        pShtp->halFailures = 0;
+    }
     if (len > 0) {
         rxAssemble(pShtp, pShtp->inTransfer, len, t_us);
     }
+
+    return len;
+}
+
+// Number of HAL reads and writes in a row that have failed.
+uint32_t shtp_halFailures(void *pInstance)
+{
+    shtp_t *pShtp = (shtp_t *)pInstance;
+
+    return pShtp->halFailures;
 }
@@ -37,14 +37,93 @@ typedef enum shtp_Event_e {
     SHTP_INTERRUPTED_PAYLOAD = 7,
 } shtp_Event_t;
 
-typedef void shtp_Callback_t(void * cookie, uint8_t *payload, uint16_t len, uint32_t timestamp);
+typedef void shtp_Callback_t(void * cookie, uint8_t *payload, uint16_t len, uint64_t timestamp);
 typedef void shtp_EventCallback_t(void *cookie, shtp_Event_t shtpEvent);
 
+// Streaming delivery.  Instead of being reassembled, a streamed payload
+// reaches the listener a piece at a time as fragments arrive, each piece
+// holding only whole reports.  A report split between fragments is held
+// back until the rest of it arrives.  first is set on the first piece of
+// each payload.
+typedef void shtp_StreamCallback_t(void *cookie, uint8_t *data, uint16_t len,
+                                   uint64_t timestamp, bool first);
+
+// Length of the report starting at pReport, from its first byte.  0 if
+// the report is not recognized, which ends delivery of that payload.
+typedef uint8_t shtp_ReportLen_t(void *cookie, const uint8_t *pReport);
+
+typedef enum shtp_StreamMode_e {
+    SHTP_STREAM_OFF = 0,        // Reassemble every payload
+    SHTP_STREAM_OVERSIZE = 1,   // Stream payloads too large to reassemble
+    SHTP_STREAM_ALWAYS = 2,     // Stream every payload, for lowest latency
+} shtp_StreamMode_t;
+
+// Longest report that can be split between fragments
+#ifndef SHTP_STREAM_CARRY_LEN
+#define SHTP_STREAM_CARRY_LEN (64)
+#endif
+
+// Footprint profiles.  SH2_FOOTPRINT_SMALL suits MCUs with little RAM,
+// SH2_FOOTPRINT_LARGE hosts that read large batch flushes.  Each size
+// below can also be set on its own.  SH2_FOOTPRINT_SMALL also leaves out
+// sh2's optional features (see SH2_WITH_... in sh2.c).
+#if defined(SH2_FOOTPRINT_SMALL)
+#define SHTP_DEFAULT_IN_TRANSFER  (256)
+#define SHTP_DEFAULT_IN_PAYLOAD   (256)
+#define SHTP_DEFAULT_OUT_TRANSFER (64)
+#elif defined(SH2_FOOTPRINT_LARGE)
+#define SHTP_DEFAULT_IN_TRANSFER  (SH2_HAL_MAX_TRANSFER_IN)
+#define SHTP_DEFAULT_IN_PAYLOAD   (4096)
+#define SHTP_DEFAULT_OUT_TRANSFER (SH2_HAL_MAX_TRANSFER_OUT)
+#else
+#define SHTP_DEFAULT_IN_TRANSFER  (SH2_HAL_MAX_TRANSFER_IN)
+#define SHTP_DEFAULT_IN_PAYLOAD   (SH2_HAL_MAX_PAYLOAD_IN)
+#define SHTP_DEFAULT_OUT_TRANSFER (SH2_HAL_MAX_TRANSFER_OUT)
+#endif
+
+// Sizes of the buffers built into each SHTP instance
+#ifndef SHTP_IN_TRANSFER_LEN
+#define SHTP_IN_TRANSFER_LEN SHTP_DEFAULT_IN_TRANSFER
+#endif
+#ifndef SHTP_IN_PAYLOAD_LEN
+#define SHTP_IN_PAYLOAD_LEN SHTP_DEFAULT_IN_PAYLOAD
+#endif
+#ifndef SHTP_OUT_TRANSFER_LEN
+#define SHTP_OUT_TRANSFER_LEN SHTP_DEFAULT_OUT_TRANSFER
+#endif
+
+// 0 leaves the buffers out of the instance, so every open must supply
+// them (shtp_openBuffers).
+#ifndef SHTP_BUILTIN_BUFFERS
+#define SHTP_BUILTIN_BUFFERS (1)
+#endif
+
+// Transfer and payload buffers for one SHTP instance.  A null pointer
+// selects the built-in buffer.  On I2C and SPI, transfers larger than
+// inTransferLen are read in pieces.  The UART HAL delivers whole frames,
+// so there inTransferLen must be at least SH2_HAL_MAX_TRANSFER_IN; a
+// larger frame is dropped and counted in rxOverflows.  Payloads larger
+// than inPayloadLen are discarded.
+typedef struct shtp_Buffers_s {
+    uint8_t *pInTransfer;
+    uint16_t inTransferLen;
+    uint8_t *pInPayload;
+    uint16_t inPayloadLen;
+    uint8_t *pOutTransfer;
+    uint16_t outTransferLen;   // At least 5: header plus one byte
+} shtp_Buffers_t;
+
 // Open the SHTP communications session.
 // Takes a pointer to a HAL, which will be opened by this function.
 // Returns a pointer referencing the open SHTP session.  (Pass this as pInstance to later calls.)
 void * shtp_open(sh2_Hal_t *pHal);
 
+// Open with the given buffers (pBuffers may be 0 for the built-in ones).
+void * shtp_openBuffers(sh2_Hal_t *pHal, const shtp_Buffers_t *pBuffers);
+
+// Bytes of state per SHTP instance, including built-in buffers.
+uint32_t shtp_instanceBytes(void);
+
 // Closes and SHTP session.
 // The associated HAL will be closed.
 void shtp_close(void *pShtp);
@@ -59,12 +138,27 @@ int shtp_listenChan(void *pShtp,
                     uint8_t channel,
                     shtp_Callback_t *callback, void * cookie);
 
+// Select streaming delivery for a channel.  callback and reportLen are
+// needed unless mode is SHTP_STREAM_OFF.
+int shtp_streamChan(void *pShtp, uint8_t channel, shtp_StreamMode_t mode,
+                    shtp_ReportLen_t *reportLen,
+                    shtp_StreamCallback_t *callback, void *cookie);
+
 // Send an SHTP payload on a particular channel
 int shtp_send(void *pShtp,
               uint8_t channel, const uint8_t *payload, uint16_t len);
 
 // Check for received data and process it.
-void shtp_service(void *pShtp);
+// Timestamps passed to channel callbacks are 64-bit microseconds, taken
+// from the HAL's readTs() if it has one, otherwise extended from the
+// 32-bit read() timestamp by counting rollovers.
+// Returns the length of the transfer processed, 0 if there was none,
+// or a negative error code from the HAL.
+int shtp_service(void *pShtp);
+
+// Number of HAL reads and writes in a row that have failed, 0 once one
+// succeeds.  A large count means the HAL itself has failed.
+uint32_t shtp_halFailures(void *pShtp);
 
 // #ifdef SHTP_H
 #endif
@@ -0,0 +1,483 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * SHTP-over-UART framing layer.
+ */
+
+#include "shtp_uart.h"
+#include "sh2_err.h"
+#include "sh2_util.h"
+
+#include <string.h>
+
+// ------------------------------------------------------------------------
+// Private types
+
+// Transmit states
+#define TX_IDLE       (0)
+#define TX_BSQ        (1)  // Sending buffer status query
+#define TX_WAIT_SPACE (2)  // Waiting for BSQ response
+#define TX_FRAME      (3)  // Sending SHTP frame
+
+// Re-send BSQ if no response arrives within this time
+#define BSQ_TIMEOUT_US (10000)
+
+// Longest a read() call spends pacing out transmit bytes
+#ifndef SHTP_UART_TX_SLICE_US
+#define SHTP_UART_TX_SLICE_US (1000)
+#endif
+
+// Scanning is done a machine word at a time.
+typedef uintptr_t word_t;
+#define WORD_ONES  ((word_t)-1 / 0xFF)   // 0x0101...01
+#define WORD_HIGHS (WORD_ONES * 0x80)    // 0x8080...80
+
+// ------------------------------------------------------------------------
+// Private data
+
+static const uint8_t bsqFrame[] = {
+    SHTP_UART_FLAG, SHTP_UART_PROTOCOL_BSQ, SHTP_UART_FLAG
+};
+
+// ------------------------------------------------------------------------
+// Private functions
+
+// True if any byte of w equals b.
+static inline bool wordHasByte(word_t w, uint8_t b)
+{
+    word_t x = w ^ (WORD_ONES * b);
+
+    return ((x - WORD_ONES) & ~x & WORD_HIGHS) != 0;
+}
+
+// Length of the leading run of bytes that are neither flag nor escape.
+// Most bytes are plain, so whole words are tested before falling back
+// to bytes for the tail.
+static unsigned plainRun(const uint8_t *p, unsigned len)
+{
+    unsigned n = 0;
+
+    while (n + sizeof(word_t) <= len) {
+        word_t w;
+        memcpy(&w, p + n, sizeof(w));
+        if (wordHasByte(w, SHTP_UART_FLAG) || wordHasByte(w, SHTP_UART_ESCAPE)) {
+            break;
+        }
+        n += sizeof(w);
+    }
+
+    while ((n < len) && (p[n] != SHTP_UART_FLAG) && (p[n] != SHTP_UART_ESCAPE)) {
+        n++;
+    }
+
+    return n;
+}
+
+static void decAppend(shtp_UartDecoder_t *pDec, const uint8_t *p, unsigned len)
+{
+    if (pDec->overflow || (len > pDec->frameMax - pDec->frameLen)) {
+        pDec->overflow = true;
+        return;
+    }
+
+    memcpy(pDec->pFrame + pDec->frameLen, p, len);
+    pDec->frameLen += len;
+}
+
+// ------------------------------------------------------------------------
+// Frame decoder/encoder
+
+void shtp_uartDecoderInit(shtp_UartDecoder_t *pDec, uint8_t *pFrame, unsigned frameMax)
+{
+    memset(pDec, 0, sizeof(shtp_UartDecoder_t));
+    pDec->pFrame = pFrame;
+    pDec->frameMax = frameMax;
+}
+
+unsigned shtp_uartDecode(shtp_UartDecoder_t *pDec, const uint8_t *pIn, unsigned len,
+                         bool *pComplete)
+{
+    unsigned cursor = 0;
+
+    *pComplete = false;
+
+    if (pDec->restart) {
+        // Previous call completed a frame, which the caller has consumed.
+        pDec->restart = false;
+        pDec->frameLen = 0;
+    }
+
+    while (cursor < len) {
+        if (!pDec->inFrame) {
+            // Hunt for an opening flag
+            const uint8_t *pFlag = memchr(pIn + cursor, SHTP_UART_FLAG, len - cursor);
+            if (pFlag == 0) {
+                return len;
+            }
+            cursor = (pFlag - pIn) + 1;
+            pDec->inFrame = true;
+            pDec->frameLen = 0;
+            pDec->escape = false;
+            pDec->overflow = false;
+            continue;
+        }
+
+        if (pDec->escape) {
+            pDec->escape = false;
+            if (pIn[cursor] != SHTP_UART_FLAG) {
+                uint8_t b = pIn[cursor++] ^ SHTP_UART_XOR;
+                decAppend(pDec, &b, 1);
+                continue;
+            }
+            // Escape followed by flag: abort this frame; the flag opens
+            // the next one.
+            pDec->frameLen = 0;
+            pDec->overflow = false;
+            cursor++;
+            continue;
+        }
+
+        unsigned run = plainRun(pIn + cursor, len - cursor);
+        if (run != 0) {
+            decAppend(pDec, pIn + cursor, run);
+            cursor += run;
+            continue;
+        }
+
+        if (pIn[cursor++] == SHTP_UART_ESCAPE) {
+            pDec->escape = true;
+            continue;
+        }
+
+        // Flag.  A flag following the opening flag (or a dropped frame)
+        // just opens the frame again.
+        if (pDec->overflow) {
+            pDec->overflows++;
+            pDec->overflow = false;
+            pDec->frameLen = 0;
+            continue;
+        }
+        if (pDec->frameLen == 0) {
+            continue;
+        }
+
+        // Frame complete.  The closing flag may also open the next frame,
+        // so stay in frame; the next call starts a new one.
+        pDec->frames++;
+        pDec->restart = true;
+        *pComplete = true;
+        return cursor;
+    }
+
+    return cursor;
+}
+
+unsigned shtp_uartEncode(uint8_t protocol, const uint8_t *pIn, unsigned len,
+                         uint8_t *pOut, unsigned outMax)
+{
+    unsigned n = 0;
+    unsigned cursor = 0;
+
+    // Checking the worst case up front keeps bounds checks out of the loop.
+    if (outMax < SHTP_UART_ENCODED_MAX(len)) {
+        return 0;
+    }
+
+    pOut[n++] = SHTP_UART_FLAG;
+    if ((protocol == SHTP_UART_FLAG) || (protocol == SHTP_UART_ESCAPE)) {
+        pOut[n++] = SHTP_UART_ESCAPE;
+        pOut[n++] = protocol ^ SHTP_UART_XOR;
+    }
+    else {
+        pOut[n++] = protocol;
+    }
+
+    while (cursor < len) {
+        unsigned run = plainRun(pIn + cursor, len - cursor);
+        memcpy(pOut + n, pIn + cursor, run);
+        n += run;
+        cursor += run;
+
+        if (cursor < len) {
+            pOut[n++] = SHTP_UART_ESCAPE;
+            pOut[n++] = pIn[cursor++] ^ SHTP_UART_XOR;
+        }
+    }
+
+    pOut[n++] = SHTP_UART_FLAG;
+
+    return n;
+}
+
+// ------------------------------------------------------------------------
+// HAL implementation
+
+static void txStart(shtp_Uart_t *pUart, uint8_t state, const uint8_t *p, unsigned len)
+{
+    pUart->txState = state;
+    pUart->pTx = p;
+    pUart->txRemaining = len;
+}
+
+// Send as much of the current frame as pacing allows.
+static int txSend(shtp_Uart_t *pUart)
+{
+    shtp_ByteStream_t *pStream = pUart->pStream;
+    int rc;
+
+    if (pUart->config.txByteGap_us == 0) {
+        rc = pStream->write(pStream, pUart->pTx, pUart->txRemaining);
+    }
+    else {
+        // Wait out the gaps between bytes, for up to one slice per call.
+        uint32_t start_us = pStream->getTimeUs(pStream);
+        uint32_t now_us = start_us;
+        while ((pUart->txRemaining != 0) &&
+               ((now_us - start_us) < SHTP_UART_TX_SLICE_US)) {
+            if ((now_us - pUart->lastTx_us) >= pUart->config.txByteGap_us) {
+                rc = pStream->write(pStream, pUart->pTx, 1);
+                if (rc <= 0) {
+                    return (rc < 0) ? rc : SH2_OK;
+                }
+                pUart->lastTx_us = now_us;
+                pUart->pTx++;
+                pUart->txRemaining--;
+            }
+            now_us = pStream->getTimeUs(pStream);
+        }
+        return SH2_OK;
+    }
+
+    if (rc < 0) {
+        return rc;
+    }
+
+    pUart->pTx += rc;
+    pUart->txRemaining -= rc;
+
+    return SH2_OK;
+}
+
+// Advance the transmit state machine.  Called on every read.
+static int txPump(shtp_Uart_t *pUart)
+{
+    shtp_ByteStream_t *pStream = pUart->pStream;
+    int rc = SH2_OK;
+
+    switch (pUart->txState) {
+        case TX_BSQ:
+            rc = txSend(pUart);
+            if (pUart->txRemaining == 0) {
+                pUart->txState = TX_WAIT_SPACE;
+                pUart->bsqValid = false;
+                pUart->bsqSent_us = pStream->getTimeUs(pStream);
+            }
+            break;
+        case TX_WAIT_SPACE:
+            if (pUart->bsqValid && (pUart->hubSpace >= pUart->txDataLen)) {
+                txStart(pUart, TX_FRAME, pUart->txFrame, pUart->txFrameLen);
+            }
+            else if (pUart->bsqValid ||
+                     ((pStream->getTimeUs(pStream) - pUart->bsqSent_us) > BSQ_TIMEOUT_US)) {
+                // Not enough room yet, or no answer: ask again.
+                pUart->bsqRetries++;
+                txStart(pUart, TX_BSQ, bsqFrame, sizeof(bsqFrame));
+            }
+            break;
+        case TX_FRAME:
+            rc = txSend(pUart);
+            if (pUart->txRemaining == 0) {
+                pUart->txState = TX_IDLE;
+                pUart->txFrameLen = 0;
+            }
+            break;
+        default:
+            break;
+    }
+
+    return rc;
+}
+
+// Handle a completed frame.  Returns the SHTP transfer length if the frame
+// carried one, otherwise 0.
+static int rxFrame(shtp_Uart_t *pUart, uint8_t *pBuffer, unsigned len, uint32_t *t_us)
+{
+    unsigned dataLen = pUart->dec.frameLen - 1;
+    const uint8_t *pData = pUart->rxFrame + 1;
+
+    switch (pUart->rxFrame[0]) {
+        case SHTP_UART_PROTOCOL_SHTP:
+            if (dataLen > len) {
+                pUart->rxOverflows++;
+                return 0;
+            }
+            memcpy(pBuffer, pData, dataLen);
+            *t_us = pUart->frameStart_us;
+            return dataLen;
+        case SHTP_UART_PROTOCOL_BSQ:
+            pUart->rxBsqResponses++;
+            if (dataLen >= 2) {
+                pUart->hubSpace = readu16(pData);
+                pUart->bsqValid = true;
+            }
+            return 0;
+        default:
+            pUart->rxUnknownProtocol++;
+            return 0;
+    }
+}
+
+static int uartOpen(sh2_Hal_t *self)
+{
+    shtp_Uart_t *pUart = (shtp_Uart_t *)self;
+
+    shtp_uartDecoderInit(&pUart->dec, pUart->rxFrame, sizeof(pUart->rxFrame));
+    pUart->rxChunkLen = 0;
+    pUart->rxChunkCursor = 0;
+    pUart->txState = TX_IDLE;
+    pUart->txFrameLen = 0;
+
+    return pUart->pStream->open(pUart->pStream);
+}
+
+static void uartClose(sh2_Hal_t *self)
+{
+    shtp_Uart_t *pUart = (shtp_Uart_t *)self;
+
+    pUart->pStream->close(pUart->pStream);
+}
+
+static int uartRead(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us)
+{
+    shtp_Uart_t *pUart = (shtp_Uart_t *)self;
+    shtp_ByteStream_t *pStream = pUart->pStream;
+    bool complete;
+    int rc;
+
+    // Keep any transmission flowing.
+    rc = txPump(pUart);
+    if (rc < 0) {
+        return rc;
+    }
+
+    for (;;) {
+        if (pUart->rxChunkCursor >= pUart->rxChunkLen) {
+            rc = pStream->read(pStream, pUart->rxChunk, sizeof(pUart->rxChunk),
+                               &pUart->rxChunkTime_us);
+            if (rc <= 0) {
+                // Nothing more has arrived (or error)
+                return rc;
+            }
+            pUart->rxChunkLen = rc;
+            pUart->rxChunkCursor = 0;
+        }
+
+        if (!pUart->dec.inFrame || pUart->dec.restart || (pUart->dec.frameLen == 0)) {
+            // A frame may start in this chunk
+            pUart->frameStart_us = pUart->rxChunkTime_us;
+        }
+
+        pUart->rxChunkCursor += shtp_uartDecode(&pUart->dec,
+                                                pUart->rxChunk + pUart->rxChunkCursor,
+                                                pUart->rxChunkLen - pUart->rxChunkCursor,
+                                                &complete);
+        if (complete) {
+            rc = rxFrame(pUart, pBuffer, len, t_us);
+            if (rc > 0) {
+                return rc;
+            }
+        }
+    }
+}
+
+static int uartWrite(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len)
+{
+    shtp_Uart_t *pUart = (shtp_Uart_t *)self;
+
+    if (len > SH2_HAL_MAX_TRANSFER_OUT) {
+        return SH2_ERR_BAD_PARAM;
+    }
+
+    if (pUart->txState != TX_IDLE) {
+        // Previous frame still going out.
+        return 0;
+    }
+
+    pUart->txFrameLen = shtp_uartEncode(SHTP_UART_PROTOCOL_SHTP, pBuffer, len,
+                                        pUart->txFrame, sizeof(pUart->txFrame));
+    pUart->txDataLen = len;
+
+    if (pUart->config.useBsq) {
+        txStart(pUart, TX_BSQ, bsqFrame, sizeof(bsqFrame));
+    }
+    else {
+        txStart(pUart, TX_FRAME, pUart->txFrame, pUart->txFrameLen);
+    }
+
+    // Start sending now; read() keeps it going.
+    int rc = txPump(pUart);
+    if (rc < 0) {
+        return rc;
+    }
+
+    return len;
+}
+
+static uint32_t uartGetTimeUs(sh2_Hal_t *self)
+{
+    shtp_Uart_t *pUart = (shtp_Uart_t *)self;
+
+    return pUart->pStream->getTimeUs(pUart->pStream);
+}
+
+static int uartGetPollFd(sh2_Hal_t *self)
+{
+    shtp_Uart_t *pUart = (shtp_Uart_t *)self;
+
+    if (pUart->pStream->getPollFd == 0) {
+        return -1;
+    }
+
+    return pUart->pStream->getPollFd(pUart->pStream);
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+sh2_Hal_t *shtp_uartInit(shtp_Uart_t *pUart, shtp_ByteStream_t *pStream,
+                         const shtp_UartConfig_t *pConfig)
+{
+    if ((pUart == 0) || (pStream == 0)) {
+        return 0;
+    }
+
+    memset(pUart, 0, sizeof(shtp_Uart_t));
+    pUart->pStream = pStream;
+    if (pConfig != 0) {
+        pUart->config = *pConfig;
+    }
+
+    pUart->hal.open = uartOpen;
+    pUart->hal.close = uartClose;
+    pUart->hal.read = uartRead;
+    pUart->hal.write = uartWrite;
+    pUart->hal.getTimeUs = uartGetTimeUs;
+    pUart->hal.getPollFd = uartGetPollFd;
+
+    return &pUart->hal;
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and 
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * SHTP-over-UART framing layer.
+ *
+ * On a UART, each SHTP transfer travels in an HDLC-style frame:
+ *
+ *   0x7E  protocol  data...  0x7E
+ *
+ * where 0x7E is the flag byte and any 0x7E or 0x7D inside the frame is
+ * sent as 0x7D followed by the byte XOR 0x20.  Protocol 0x01 carries an
+ * SHTP transfer, protocol 0x00 is a buffer status query (BSQ) whose
+ * response gives the free space in the hub's receive buffer.
+ *
+ * This module turns a raw byte stream (shtp_ByteStream_t) into an
+ * sh2_Hal_t that can be passed to sh2_open().
+ */
+
+#ifndef SHTP_UART_H
+#define SHTP_UART_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sh2_hal.h"
+
+#define SHTP_UART_FLAG    (0x7E)
+#define SHTP_UART_ESCAPE  (0x7D)
+#define SHTP_UART_XOR     (0x20)
+
+#define SHTP_UART_PROTOCOL_BSQ  (0x00)
+#define SHTP_UART_PROTOCOL_SHTP (0x01)
+
+// Worst case encoded frame size for a given number of data bytes
+#define SHTP_UART_ENCODED_MAX(len) (3 + 2*(1 + (len)))
+
+// Raw byte-stream device underneath the framing layer.  Functions follow
+// the conventions of sh2_Hal_t: read and write must not block, and may
+// return 0 when no bytes can be moved.
+typedef struct shtp_ByteStream_s shtp_ByteStream_t;
+struct shtp_ByteStream_s {
+    int (*open)(shtp_ByteStream_t *self);
+    void (*close)(shtp_ByteStream_t *self);
+
+    // Read up to len bytes that have already arrived.  t_us receives the
+    // time the bytes were received.  Returns the number of bytes read.
+    int (*read)(shtp_ByteStream_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us);
+
+    // Write up to len bytes.  Returns the number of bytes accepted.
+    int (*write)(shtp_ByteStream_t *self, const uint8_t *pBuffer, unsigned len);
+
+    uint32_t (*getTimeUs)(shtp_ByteStream_t *self);
+
+    // Optional, may be 0.  See getPollFd in sh2_Hal_t.
+    int (*getPollFd)(shtp_ByteStream_t *self);
+};
+
+// Incremental frame decoder.
+typedef struct shtp_UartDecoder_s {
+    uint8_t *pFrame;        // Receives protocol byte followed by unstuffed data
+    unsigned frameMax;
+    unsigned frameLen;
+    bool inFrame;
+    bool escape;
+    bool overflow;
+    bool restart;
+
+    // Stats
+    uint32_t frames;
+    uint32_t overflows;
+} shtp_UartDecoder_t;
+
+// Prepare a decoder that assembles frames into pFrame.
+void shtp_uartDecoderInit(shtp_UartDecoder_t *pDec, uint8_t *pFrame, unsigned frameMax);
+
+// Feed received bytes to the decoder.  Decoding stops right after a frame
+// is completed so the caller can consume it before feeding the rest.
+// Returns the number of bytes consumed and sets *pComplete if a frame
+// (protocol byte plus data, frameLen bytes in pFrame) is ready.
+unsigned shtp_uartDecode(shtp_UartDecoder_t *pDec, const uint8_t *pIn, unsigned len,
+                         bool *pComplete);
+
+// Encode one frame into pOut.  Returns the encoded length, or 0 if it
+// would not fit in outMax bytes.
+unsigned shtp_uartEncode(uint8_t protocol, const uint8_t *pIn, unsigned len,
+                         uint8_t *pOut, unsigned outMax);
+
+// Size of the buffer used to pull bytes from the byte stream
+#define SHTP_UART_RX_CHUNK (256)
+
+typedef struct shtp_UartConfig_s {
+    // Minimum gap between transmitted bytes.  Hubs that service their
+    // UART a byte at a time need about 100us.  0 sends frames in bursts.
+    // Each read() call spends up to SHTP_UART_TX_SLICE_US sending paced
+    // bytes, so a frame takes as many calls as its length times the gap
+    // exceeds the slice.
+    uint32_t txByteGap_us;
+
+    // Query hub buffer space (BSQ) before each transmitted frame.
+    bool useBsq;
+
+    // With pacing or BSQ, writes are completed by later read() calls, so
+    // event-loop users must keep calling sh2_service() while sending.
+} shtp_UartConfig_t;
+
+typedef struct shtp_Uart_s {
+    sh2_Hal_t hal;          // Must be first: pointer is passed to sh2_open()
+    shtp_ByteStream_t *pStream;
+    shtp_UartConfig_t config;
+
+    // Receive
+    shtp_UartDecoder_t dec;
+    uint8_t rxFrame[1 + SH2_HAL_MAX_TRANSFER_IN];
+    uint8_t rxChunk[SHTP_UART_RX_CHUNK];
+    unsigned rxChunkLen;
+    unsigned rxChunkCursor;
+    uint32_t rxChunkTime_us;
+    uint32_t frameStart_us;
+
+    // Transmit
+    uint8_t txFrame[SHTP_UART_ENCODED_MAX(SH2_HAL_MAX_TRANSFER_OUT)];
+    unsigned txFrameLen;
+    unsigned txDataLen;      // Unencoded length, checked against BSQ space
+    uint8_t txState;
+    const uint8_t *pTx;      // Next byte to send in the current frame
+    unsigned txRemaining;
+    uint32_t lastTx_us;
+    uint32_t bsqSent_us;
+    bool bsqValid;
+    uint16_t hubSpace;
+
+    // Stats
+    uint32_t rxBsqResponses;
+    uint32_t rxUnknownProtocol;
+    uint32_t rxOverflows;
+    uint32_t bsqRetries;
+} shtp_Uart_t;
+
+// Initialize a UART framing instance on top of a byte stream.
+// Returns the sh2_Hal_t to pass to sh2_open().
+sh2_Hal_t *shtp_uartInit(shtp_Uart_t *pUart, shtp_ByteStream_t *pStream,
+                         const shtp_UartConfig_t *pConfig);
+
+#endif
@@ -0,0 +1,387 @@
+/*
+ * Copyright 2026 CEVA, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License and
+ * any applicable agreements you may have with CEVA, Inc.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * test_host: host checks for the helper modules, no hub needed.
+ *
+ * Build and run from the repository root:
+ *   gcc -std=gnu11 -I. tests/test_host.c sh2_profile.c sh2_caps.c sh2_stats.c \
+ *       sh2_resample.c sh2.c shtp.c sh2_util.c sh2_SensorValue.c -lm -o test_host
+ *   ./test_host
+ *
+ * Covers profile parsing, capability cache hits and misses against a
+ * simulated hub, Allan deviation of white noise and resampler
+ * interpolation.  Exits non-zero if any check fails.
+ */
+
+#include "sh2.h"
+#include "sh2_err.h"
+#include "sh2_caps.h"
+#include "sh2_profile.h"
+#include "sh2_resample.h"
+#include "sh2_stats.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// ------------------------------------------------------------------------
+// Private definitions
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+#define NEAR(a, b, tol) (fabs((double)(a) - (double)(b)) <= (tol))
+
+// Simulated hub replies waiting to be read
+#define HUB_QUEUE_LEN (8)
+#define HUB_TRANSFER_MAX (32)
+
+// Control channel reports the simulated hub answers
+#define PROD_ID_REQ   (0xF9)
+#define PROD_ID_RESP  (0xF8)
+#define FRS_READ_REQ  (0xF4)
+#define FRS_READ_RESP (0xF3)
+
+#define FRS_STATUS_UNRECOGNIZED (1)
+#define FRS_STATUS_EMPTY        (5)
+
+// ------------------------------------------------------------------------
+// Private data
+
+static unsigned checks;
+static unsigned failures;
+
+static struct {
+    uint8_t transfer[HUB_QUEUE_LEN][HUB_TRANSFER_MAX];
+    uint8_t len[HUB_QUEUE_LEN];
+    unsigned in;
+    unsigned out;
+    uint8_t seq;
+    uint32_t partNumber;     // Firmware the hub reports
+    unsigned prodIdReqs;
+    unsigned frsReads;
+} hub;
+
+static sh2_ResampleFrame_t frames[8];
+static unsigned frameCount;
+
+// ------------------------------------------------------------------------
+// Private functions
+
+static void check(bool ok, const char *what, int line)
+{
+    checks++;
+    if (!ok) {
+        failures++;
+        printf("FAIL line %d: %s\n", line, what);
+    }
+}
+
+static uint32_t fakeTime_us;
+
+static uint32_t hubGetTimeUs(sh2_Hal_t *self)
+{
+    (void)self;  // unused
+
+    // Every look at the clock moves it on, so op timeouts expire.
+    return fakeTime_us += 10;
+}
+
+static int hubOpen(sh2_Hal_t *self)
+{
+    (void)self;  // unused
+
+    return 0;
+}
+
+static void hubClose(sh2_Hal_t *self)
+{
+    (void)self;  // unused
+}
+
+// Queue a control channel reply.
+static void hubReply(const uint8_t *pPayload, unsigned len)
+{
+    uint8_t *p = hub.transfer[hub.in % HUB_QUEUE_LEN];
+
+    p[0] = (uint8_t)(len + 4);
+    p[1] = 0;
+    p[2] = 2;
+    p[3] = hub.seq++;
+    memcpy(p + 4, pPayload, len);
+    hub.len[hub.in % HUB_QUEUE_LEN] = (uint8_t)(len + 4);
+    hub.in++;
+}
+
+static int hubRead(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len, uint32_t *t_us)
+{
+    if ((hub.out == hub.in) || (len < HUB_TRANSFER_MAX)) {
+        return 0;
+    }
+
+    unsigned n = hub.len[hub.out % HUB_QUEUE_LEN];
+    memcpy(pBuffer, hub.transfer[hub.out % HUB_QUEUE_LEN], n);
+    hub.out++;
+    *t_us = hubGetTimeUs(self);
+
+    return (int)n;
+}
+
+// Answers product id requests, and FRS reads: the accelerometer
+// metadata record exists but is empty, every other record is unknown.
+static int hubWrite(sh2_Hal_t *self, uint8_t *pBuffer, unsigned len)
+{
+    (void)self;  // unused
+
+    const uint8_t *pReq = pBuffer + 4;
+    uint8_t resp[16];
+
+    if ((len < 5) || (pBuffer[2] != 2)) {
+        return (int)len;
+    }
+
+    memset(resp, 0, sizeof(resp));
+    if (pReq[0] == PROD_ID_REQ) {
+        hub.prodIdReqs++;
+        for (unsigned n = 0; n < 4; n++) {
+            resp[0] = PROD_ID_RESP;
+            resp[2] = 3;  // Version 3.n
+            resp[3] = (uint8_t)n;
+            memcpy(&resp[4], &hub.partNumber, sizeof(hub.partNumber));
+            hubReply(resp, sizeof(resp));
+        }
+    }
+    else if (pReq[0] == FRS_READ_REQ) {
+        uint16_t frsType = (uint16_t)(pReq[4] | (pReq[5] << 8));
+
+        hub.frsReads++;
+        resp[0] = FRS_READ_RESP;
+        resp[1] = (frsType == FRS_ID_META_ACCELEROMETER) ?
+            FRS_STATUS_EMPTY : FRS_STATUS_UNRECOGNIZED;
+        resp[12] = pReq[4];
+        resp[13] = pReq[5];
+        hubReply(resp, sizeof(resp));
+    }
+
+    return (int)len;
+}
+
+static sh2_Hal_t hubHal = {
+    .open = hubOpen,
+    .close = hubClose,
+    .read = hubRead,
+    .write = hubWrite,
+    .getTimeUs = hubGetTimeUs,
+};
+
+// Deterministic normal deviates (LCG and Box-Muller).
+static double gaussian(void)
+{
+    static uint32_t state = 12345;
+    double u1;
+    double u2;
+
+    do {
+        state = state * 1664525u + 1013904223u;
+        u1 = (state >> 8) / 16777216.0;
+    } while (u1 <= 0.0);
+    state = state * 1664525u + 1013904223u;
+    u2 = (state >> 8) / 16777216.0;
+
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static void onFrame(void *cookie, const sh2_ResampleFrame_t *pFrame)
+{
+    (void)cookie;  // unused
+
+    if (frameCount < sizeof(frames) / sizeof(frames[0])) {
+        frames[frameCount] = *pFrame;
+    }
+    frameCount++;
+}
+
+// ------------------------------------------------------------------------
+// Tests
+
+static void testProfileParse(void)
+{
+    sh2_Profile_t profile;
+    unsigned line = 0;
+
+    const char *good =
+        "# comment\n"
+        "sensor 0x05 interval=10000 batch=0 sensitivity=3 specific=0xFFFFFFFF changeOn wake\n"
+        "cal 0x07\n"
+        "dcdAutoSave 1\n"
+        "reorientation 0 0 0.7071 0.7071\n"
+        "frs 0x2d3e 1 0x2\n";
+
+    CHECK(sh2_profileParse(good, &profile, &line) == SH2_OK);
+    CHECK(profile.sensors == 1);
+    CHECK(profile.sensor[0].sensorId == 5);
+    CHECK(profile.sensor[0].config.reportInterval_us == 10000);
+    CHECK(profile.sensor[0].config.changeSensitivity == 3);
+    CHECK(profile.sensor[0].config.sensorSpecific == 0xFFFFFFFF);
+    CHECK(profile.sensor[0].config.changeSensitivityEnabled);
+    CHECK(profile.sensor[0].config.wakeupEnabled);
+    CHECK(!profile.sensor[0].config.sniffEnabled);
+    CHECK(profile.hasCalConfig && (profile.calConfig == 7));
+    CHECK(profile.hasDcdAutoSave && profile.dcdAutoSave);
+    CHECK(profile.hasReorientation && NEAR(profile.reorientation.w, 0.7071, 1e-9));
+    CHECK((profile.frsRecords == 1) && (profile.frs[0].recordId == 0x2d3e));
+    CHECK((profile.frs[0].words == 2) && (profile.frs[0].data[1] == 2));
+
+    // Signs, range and trailing junk are rejected, on the right line.
+    CHECK(sh2_profileParse("\nsensor 5 interval=-1\n", &profile, &line) == SH2_ERR_BAD_PARAM);
+    CHECK(line == 2);
+    CHECK(sh2_profileParse("sensor 5 interval=4294967296\n", &profile, &line) == SH2_ERR_BAD_PARAM);
+    CHECK(sh2_profileParse("sensor 5 interval=10x\n", &profile, &line) == SH2_ERR_BAD_PARAM);
+    CHECK(sh2_profileParse("sensor 5 sensitivity=65536\n", &profile, &line) == SH2_ERR_BAD_PARAM);
+    CHECK(sh2_profileParse("sensor 0x2F\n", &profile, &line) == SH2_ERR_BAD_PARAM);
+    CHECK(sh2_profileParse("dcdAutoSave 2\n", &profile, &line) == SH2_ERR_BAD_PARAM);
+    CHECK(sh2_profileParse("cal 1 2\n", &profile, &line) == SH2_ERR_BAD_PARAM);
+    CHECK(sh2_profileParse("sensor 5 interval=4294967295\n", &profile, &line) == SH2_OK);
+    CHECK(profile.sensor[0].config.reportInterval_us == UINT32_MAX);
+}
+
+static void testCapsDetect(void)
+{
+    sh2_CapsCache_t cache;
+    const sh2_Caps_t *pCaps = 0;
+    bool fromCache = true;
+
+    memset(&hub, 0, sizeof(hub));
+    hub.partNumber = 10003606;
+    CHECK(sh2_open(&hubHal, 0, 0) == SH2_OK);
+    sh2_capsCacheInit(&cache);
+
+    // Miss: probe every sensor's metadata.
+    CHECK(sh2_capsDetect(&cache, SH2_CAPS_PROBE_SENSORS, &pCaps, &fromCache) == SH2_OK);
+    CHECK(!fromCache);
+    CHECK((pCaps != 0) && pCaps->valid);
+    CHECK(sh2_capsHasSensor(pCaps, SH2_ACCELEROMETER));
+    CHECK(!sh2_capsHasSensor(pCaps, SH2_GYROSCOPE_CALIBRATED));
+    CHECK(hub.frsReads > 0);
+
+    // Hit: only the product ids are read.
+    unsigned frsReads = hub.frsReads;
+    CHECK(sh2_capsDetect(&cache, SH2_CAPS_PROBE_SENSORS, &pCaps, &fromCache) == SH2_OK);
+    CHECK(fromCache);
+    CHECK(hub.frsReads == frsReads);
+    CHECK(hub.prodIdReqs == 2);
+
+    // Other firmware: a miss again.
+    hub.partNumber = 10004095 + 1;
+    CHECK(sh2_capsDetect(&cache, SH2_CAPS_PROBE_SENSORS, &pCaps, &fromCache) == SH2_OK);
+    CHECK(!fromCache);
+    CHECK(hub.frsReads > frsReads);
+
+    sh2_close();
+}
+
+static void testStatsAllan(void)
+{
+    sh2_SensorStats_t stats;
+    sh2_StatsResult_t result;
+    sh2_SensorValue_t value;
+    const double sigma = 0.05;
+
+    CHECK(sh2_statsInit(&stats, SH2_ACCELEROMETER) == SH2_OK);
+
+    // White noise at 100 Hz: ADEV(tau) = sigma / sqrt(m), m reports per cluster.
+    memset(&value, 0, sizeof(value));
+    value.sensorId = SH2_ACCELEROMETER;
+    for (unsigned n = 0; n < 200000; n++) {
+        value.timestamp = 1000000 + (uint64_t)n * 10000;
+        value.un.accelerometer.x = (float)(9.8 + sigma * gaussian());
+        value.un.accelerometer.y = 0.0f;
+        value.un.accelerometer.z = 1.0f;
+        sh2_statsInput(&stats, &value);
+    }
+
+    CHECK(sh2_statsGet(&stats, &result) == SH2_OK);
+    CHECK(result.samples == 200000);
+    CHECK(NEAR(result.mean[0], 9.8, 0.001));
+    CHECK(NEAR(result.stdDev[0], sigma, sigma * 0.02));
+    CHECK(NEAR(result.intervalMean_us, 10000, 0.01));
+    CHECK(result.adevLevels == SH2_STATS_ADEV_LEVELS);
+    for (unsigned level = 0; level < result.adevLevels; level++) {
+        double m = (double)(1u << level);
+        CHECK(NEAR(result.tau_s[level], 0.01 * m, 1e-6));
+        CHECK(NEAR(result.adev[0][level], sigma / sqrt(m), sigma / sqrt(m) * 0.1));
+    }
+    CHECK(result.adev[1][0] == 0.0f);
+}
+
+static void testResample(void)
+{
+    sh2_Resampler_t rs;
+    sh2_SensorValue_t accel;
+    sh2_SensorValue_t grv;
+    const double h = sqrt(0.5);
+
+    frameCount = 0;
+    CHECK(sh2_resampleInit(&rs, 10000, 100000, onFrame, 0) == SH2_OK);
+    CHECK(sh2_resampleAddChannel(&rs, SH2_ACCELEROMETER) == 0);
+    CHECK(sh2_resampleAddChannel(&rs, SH2_GAME_ROTATION_VECTOR) == 1);
+
+    // Accelerometer x ramps 0 to 2 and the GRV turns 90 degrees about z
+    // between t = 0 and t = 20 ms.
+    memset(&accel, 0, sizeof(accel));
+    accel.sensorId = SH2_ACCELEROMETER;
+    memset(&grv, 0, sizeof(grv));
+    grv.sensorId = SH2_GAME_ROTATION_VECTOR;
+
+    accel.timestamp = 0;
+    sh2_resampleInput(&rs, &accel);
+    grv.timestamp = 0;
+    grv.un.gameRotationVector.real = 1.0f;
+    sh2_resampleInput(&rs, &grv);
+
+    accel.timestamp = 20000;
+    accel.un.accelerometer.x = 2.0f;
+    sh2_resampleInput(&rs, &accel);
+    grv.timestamp = 20000;
+    grv.un.gameRotationVector.k = (float)h;
+    grv.un.gameRotationVector.real = (float)h;
+    sh2_resampleInput(&rs, &grv);
+
+    // Frames at 0, 10 and 20 ms: every channel has reached 20 ms.
+    CHECK(frameCount == 3);
+    CHECK(frames[1].t_us == 10000);
+    CHECK(frames[1].valid == 0x03);
+    CHECK(NEAR(frames[1].value[0][0], 1.0, 1e-6));
+    CHECK(NEAR(frames[1].value[1][2], sin(M_PI / 8), 1e-6));
+    CHECK(NEAR(frames[1].value[1][3], cos(M_PI / 8), 1e-6));
+    CHECK(NEAR(frames[2].value[0][0], 2.0, 1e-6));
+    CHECK(rs.stats.partialFrames == 0);
+}
+
+// ------------------------------------------------------------------------
+// Public functions
+
+int main(void)
+{
+    testProfileParse();
+    testCapsDetect();
+    testStatsAllan();
+    testResample();
+
+    printf("%u checks, %u failed\n", checks, failures);
+
+    return (failures == 0) ? 0 : 1;
+}